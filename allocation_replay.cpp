@@ -0,0 +1,236 @@
+#include "allocation_replay.h"
+
+#include "pool_list.h"
+
+#include <algorithm> // lower_bound
+#include <chrono>
+#include <exception>
+#include <limits>
+
+namespace ldl {
+
+    namespace {
+
+        // a block allocated during a replay, keyed by its address in the trace.
+        struct ReplayBlock {
+            void* ptr;
+            size_t pool_block_size;
+            size_t requested_size;
+        };
+
+        // type of map of live blocks.
+        typedef std::map<c11::uint64_t, ReplayBlock> ReplayBlockMap;
+
+    } // namespace
+
+    //--------------
+    ReplayResult::ReplayResult()
+        : pops(0)
+        , pushes(0)
+        , failed_pops(0)
+        , growth_events(0)
+        , peak_bytes_reserved(0)
+        , peak_bytes_in_use(0)
+        , peak_bytes_requested(0)
+        , internal_fragmentation(0)
+        , idle_fraction(0)
+        , elapsed_seconds(0)
+    {}
+
+    //--------------
+    ReplayResult AllocationReplay::Run(const std::vector<AllocationTraceRecord>& records, const ReplayConfig& config)
+    {
+        ReplayResult retval;
+        PoolList pool_list;
+        pool_list.SetPoolGrowthStep(0, config.growth_step);
+        for (std::map<size_t, size_t>::const_iterator it = config.preallocation.begin(); it != config.preallocation.end(); ++it) {
+            pool_list.IncreasePoolSize(it->first, it->second);
+        }
+
+        ReplayBlockMap live;
+        size_t bytes_reserved = 0;
+        size_t bytes_in_use = 0;
+        size_t bytes_requested = 0;
+        size_t bytes_reserved_at_peak = 0;
+        std::vector<PoolStats> stats;
+        pool_list.GetStats(stats);
+        for (std::vector<PoolStats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+            bytes_reserved += it->bytes_reserved;
+        }
+        retval.peak_bytes_reserved = bytes_reserved;
+
+        // time the whole replay. The bookkeeping is the same for every configuration.
+        c11::chrono::steady_clock::time_point start_time = c11::chrono::steady_clock::now();
+        for (std::vector<AllocationTraceRecord>::const_iterator it = records.begin(); it != records.end(); ++it) {
+            if (!it->IsFree()) {
+                ReplayBlock block;
+                block.requested_size = it->GetBlockSize();
+                block.pool_block_size = GetSizeClass(config.size_classes, block.requested_size);
+                Pool& pool = pool_list.GetPool(block.pool_block_size);
+                size_t num_blocks = pool.GetSize();
+                try {
+                    block.ptr = pool.Pop();
+                }
+                catch (const std::bad_alloc&) {
+                    ++retval.failed_pops;
+                    continue;
+                }
+                ++retval.pops;
+                bytes_reserved += (pool.GetSize() - num_blocks) * block.pool_block_size;
+                bytes_in_use += block.pool_block_size;
+                bytes_requested += block.requested_size;
+                live[it->address] = block;
+                if (bytes_in_use > retval.peak_bytes_in_use) {
+                    retval.peak_bytes_in_use = bytes_in_use;
+                    retval.peak_bytes_requested = bytes_requested;
+                    bytes_reserved_at_peak = bytes_reserved;
+                }
+                if (bytes_reserved > retval.peak_bytes_reserved) {
+                    retval.peak_bytes_reserved = bytes_reserved;
+                }
+            }
+            else {
+                ReplayBlockMap::iterator block = live.find(it->address);
+                if (block == live.end()) { // allocated before the trace started, or its allocation failed
+                    continue;
+                }
+                pool_list.Push(block->second.pool_block_size, block->second.ptr);
+                ++retval.pushes;
+                bytes_in_use -= block->second.pool_block_size;
+                bytes_requested -= block->second.requested_size;
+                live.erase(block);
+            }
+        }
+        retval.elapsed_seconds = c11::chrono::duration<double>(c11::chrono::steady_clock::now() - start_time).count();
+
+        pool_list.GetStats(stats);
+        for (std::vector<PoolStats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+            retval.growth_events += it->growth_events;
+        }
+        if (retval.peak_bytes_in_use) {
+            retval.internal_fragmentation = 1.0 - static_cast<double>(retval.peak_bytes_requested) / retval.peak_bytes_in_use;
+        }
+        if (bytes_reserved_at_peak) {
+            retval.idle_fraction = 1.0 - static_cast<double>(retval.peak_bytes_in_use) / bytes_reserved_at_peak;
+        }
+
+        // return the blocks that were never freed, so pool_list can release them.
+        for (ReplayBlockMap::iterator it = live.begin(); it != live.end(); ++it) {
+            pool_list.Push(it->second.pool_block_size, it->second.ptr);
+        }
+        return retval;
+    }
+
+    //--------------
+    std::vector<size_t> AllocationReplay::SuggestSizeClasses(const std::vector<AllocationTraceRecord>& records, size_t max_classes)
+    {
+        std::map<size_t, size_t> peak_blocks = SuggestPreallocation(records, std::vector<size_t>());
+        std::vector<size_t> sizes;
+        std::vector<double> weights;
+        for (std::map<size_t, size_t>::const_iterator it = peak_blocks.begin(); it != peak_blocks.end(); ++it) {
+            sizes.push_back(it->first);
+            weights.push_back(static_cast<double>(it->second));
+        }
+        const size_t n = sizes.size();
+        if (n <= max_classes || max_classes == 0) {
+            return sizes;
+        }
+
+        // prefix sums of weights and weighted sizes, so the cost of any range is O(1)
+        std::vector<double> sum_w(n + 1, 0.0);
+        std::vector<double> sum_ws(n + 1, 0.0);
+        for (size_t ix = 0; ix < n; ++ix) {
+            sum_w[ix + 1] = sum_w[ix] + weights[ix];
+            sum_ws[ix + 1] = sum_ws[ix] + weights[ix] * sizes[ix];
+        }
+        // bytes wasted by serving sizes[first..last] from a class of size sizes[last]
+        struct RangeCost {
+            const std::vector<size_t>& sizes;
+            const std::vector<double>& sum_w;
+            const std::vector<double>& sum_ws;
+            double operator()(size_t first, size_t last) const {
+                return sizes[last] * (sum_w[last + 1] - sum_w[first]) - (sum_ws[last + 1] - sum_ws[first]);
+            }
+        } cost = { sizes, sum_w, sum_ws };
+
+        // dynamic program: best[k][j] = least waste covering sizes[0..j] with k+1 classes, the largest being sizes[j]
+        const double infinity = std::numeric_limits<double>::max();
+        std::vector<std::vector<double> > best(max_classes, std::vector<double>(n, infinity));
+        std::vector<std::vector<size_t> > prev(max_classes, std::vector<size_t>(n, 0));
+        for (size_t j = 0; j < n; ++j) {
+            best[0][j] = cost(0, j);
+        }
+        for (size_t k = 1; k < max_classes; ++k) {
+            for (size_t j = k; j < n; ++j) {
+                for (size_t i = k - 1; i < j; ++i) {
+                    double value = best[k - 1][i] + cost(i + 1, j);
+                    if (value < best[k][j]) {
+                        best[k][j] = value;
+                        prev[k][j] = i;
+                    }
+                }
+            }
+        }
+
+        // trace back the classes from the largest size
+        std::vector<size_t> retval(max_classes);
+        size_t j = n - 1;
+        for (size_t k = max_classes; k-- > 0;) {
+            retval[k] = sizes[j];
+            j = prev[k][j];
+        }
+        return retval;
+    }
+
+    //--------------
+    std::map<size_t, size_t> AllocationReplay::SuggestPreallocation(const std::vector<AllocationTraceRecord>& records,
+        const std::vector<size_t>& size_classes)
+    {
+        std::map<size_t, size_t> retval; // peak live blocks per pool
+        std::map<size_t, size_t> live_blocks; // current live blocks per pool
+        std::map<c11::uint64_t, size_t> live; // pool of each live address
+        for (std::vector<AllocationTraceRecord>::const_iterator it = records.begin(); it != records.end(); ++it) {
+            if (!it->IsFree()) {
+                size_t pool_block_size = GetSizeClass(size_classes, it->GetBlockSize());
+                live[it->address] = pool_block_size;
+                size_t& count = live_blocks[pool_block_size];
+                ++count;
+                size_t& peak = retval[pool_block_size];
+                if (count > peak) {
+                    peak = count;
+                }
+            }
+            else {
+                std::map<c11::uint64_t, size_t>::iterator block = live.find(it->address);
+                if (block != live.end()) {
+                    --live_blocks[block->second];
+                    live.erase(block);
+                }
+            }
+        }
+        return retval;
+    }
+
+    //--------------
+    void AllocationReplay::WriteResult(std::ostream& os, const ReplayResult& result)
+    {
+        os << "pops=" << result.pops
+            << " pushes=" << result.pushes
+            << " failed_pops=" << result.failed_pops
+            << " growth_events=" << result.growth_events
+            << " peak_bytes_reserved=" << result.peak_bytes_reserved
+            << " peak_bytes_in_use=" << result.peak_bytes_in_use
+            << " internal_fragmentation=" << result.internal_fragmentation
+            << " idle_fraction=" << result.idle_fraction
+            << " elapsed_seconds=" << result.elapsed_seconds
+            << "\n";
+    }
+
+    //--------------
+    size_t AllocationReplay::GetSizeClass(const std::vector<size_t>& size_classes, size_t block_size)
+    {
+        std::vector<size_t>::const_iterator it = std::lower_bound(size_classes.begin(), size_classes.end(), block_size);
+        return (it != size_classes.end()) ? *it : block_size;
+    }
+
+} //namespace ldl
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef LDL_ALLOCATION_REPLAY_H_
+#define LDL_ALLOCATION_REPLAY_H_
+
+#include "allocation_trace.h" // AllocationTraceRecord
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace ldl {
+
+    //-------------
+    /// PoolList configuration to replay a trace against.
+    struct ReplayConfig {
+        // growth_step of all pools. (see PoolList::SetPoolGrowthStep()) The default grows one block at a time,
+        // so bytes reserved follow the peak exactly. 0 disables growth, so allocations beyond the preallocation fail.
+        int growth_step;
+
+        // sorted list of block sizes. Each allocation is served by the smallest size class that fits it.
+        // If empty (the default), each block size gets its own pool.
+        std::vector<size_t> size_classes;
+
+        // number of blocks to reserve up front in each pool, keyed by pool block size.
+        std::map<size_t, size_t> preallocation;
+
+        ReplayConfig() : growth_step(1) {}
+    };
+
+    //-------------
+    /// Results of replaying a trace.
+    struct ReplayResult {
+        // number of allocations and frees replayed.
+        size_t pops;
+        size_t pushes;
+
+        // number of allocations that failed because a pool couldn't grow. (their frees are skipped)
+        size_t failed_pops;
+
+        // number of times a pool grew automatically.
+        size_t growth_events;
+
+        // highest number of bytes reserved by all pools.
+        size_t peak_bytes_reserved;
+
+        // highest number of bytes in use (rounded up to size classes), and the bytes requested at that time.
+        size_t peak_bytes_in_use;
+        size_t peak_bytes_requested;
+
+        // fraction of the bytes in use at the peak that were lost to rounding up to size classes.
+        double internal_fragmentation;
+
+        // fraction of the reserved bytes that were not in use at the peak.
+        double idle_fraction;
+
+        // time taken to replay the trace (seconds). Includes bookkeeping that is the same for every configuration.
+        double elapsed_seconds;
+
+        ReplayResult();
+    };
+
+    //-------------
+    /// Offline replay of allocation traces recorded by AllocationTrace, for tuning PoolList configurations.
+    class AllocationReplay {
+    public:
+
+        // replay records against a PoolList configured by config.
+        static ReplayResult Run(const std::vector<AllocationTraceRecord>& records, const ReplayConfig& config);
+
+        // return at most max_classes size classes that minimize the bytes lost to rounding up,
+        // weighted by the peak number of live blocks of each requested size.
+        static std::vector<size_t> SuggestSizeClasses(const std::vector<AllocationTraceRecord>& records, size_t max_classes);
+
+        // return the number of blocks to preallocate in each pool so the trace runs without growth:
+        // the peak number of live blocks of each size class. (an empty size_classes means exact sizes.)
+        static std::map<size_t, size_t> SuggestPreallocation(const std::vector<AllocationTraceRecord>& records,
+            const std::vector<size_t>& size_classes);
+
+        // write a one-line summary of result.
+        static void WriteResult(std::ostream& os, const ReplayResult& result);
+
+    private:
+
+        // return the smallest size class that can hold block_size (or block_size itself if there is none)
+        static size_t GetSizeClass(const std::vector<size_t>& size_classes, size_t block_size);
+    };
+
+} //namespace ldl
+
+#endif //! LDL_ALLOCATION_REPLAY_H_
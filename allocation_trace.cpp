@@ -0,0 +1,164 @@
+#include "allocation_trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring> // memcmp
+#include <mutex>
+
+namespace ldl {
+
+    namespace {
+
+        // identifies a trace file (followed by a 4 byte version number)
+        const char TRACE_MAGIC[8] = { 'L', 'D', 'L', 'T', 'R', 'A', 'C', 'E' };
+
+        // version of the trace file format
+        const c11::uint32_t TRACE_VERSION = 1;
+
+        // number of records buffered before they are written to the file
+        const size_t BUFFER_SIZE = 4096;
+
+        // state of the recorder (protected by mutex)
+        struct TraceState {
+            TraceState() : file(0) {}
+            c11::mutex mutex;
+            std::FILE* file;
+            c11::chrono::steady_clock::time_point start_time;
+            std::vector<AllocationTraceRecord> buffer;
+        };
+
+        // true while a trace is being recorded
+        c11::atomic<bool> recording_(false);
+
+        // next thread id to assign
+        c11::atomic<c11::uint32_t> next_thread_id_(0);
+
+        //--------------
+        // constructed on first use, so blocks can be traced during static initialization.
+        TraceState& GetState()
+        {
+            static TraceState state;
+            return state;
+        }
+
+        //--------------
+        // return the trace id of the calling thread.
+        c11::uint32_t GetThreadId()
+        {
+            static thread_local c11::uint32_t thread_id = next_thread_id_.fetch_add(1, c11::memory_order_relaxed);
+            return thread_id;
+        }
+
+        //--------------
+        // write the buffered records to the file. (state.mutex must be held)
+        void Flush(TraceState& state)
+        {
+            if (state.file && !state.buffer.empty()) {
+                std::fwrite(&state.buffer[0], sizeof(AllocationTraceRecord), state.buffer.size(), state.file);
+            }
+            state.buffer.clear();
+        }
+
+    } // namespace
+
+    //--------------
+    bool AllocationTrace::Start(const std::string& filename)
+    {
+        Stop();
+        TraceState& state = GetState();
+        c11::lock_guard<c11::mutex> lock(state.mutex);
+        state.file = std::fopen(filename.c_str(), "wb");
+        if (!state.file) {
+            return false;
+        }
+        std::fwrite(TRACE_MAGIC, sizeof(TRACE_MAGIC), 1, state.file);
+        std::fwrite(&TRACE_VERSION, sizeof(TRACE_VERSION), 1, state.file);
+        state.buffer.reserve(BUFFER_SIZE);
+        state.start_time = c11::chrono::steady_clock::now();
+        recording_.store(true, c11::memory_order_release);
+        return true;
+    }
+
+    //--------------
+    void AllocationTrace::Stop()
+    {
+        TraceState& state = GetState();
+        c11::lock_guard<c11::mutex> lock(state.mutex);
+        recording_.store(false, c11::memory_order_relaxed);
+        Flush(state);
+        if (state.file) {
+            std::fclose(state.file);
+            state.file = 0;
+        }
+    }
+
+    //--------------
+    bool AllocationTrace::IsRecording()
+    {
+        return recording_.load(c11::memory_order_relaxed);
+    }
+
+    //--------------
+    void AllocationTrace::RecordPop(size_t block_size, void* ptr)
+    {
+        if (recording_.load(c11::memory_order_relaxed) && ptr) {
+            Record(block_size, ptr, false);
+        }
+    }
+
+    //--------------
+    void AllocationTrace::RecordPush(size_t block_size, void* ptr)
+    {
+        if (recording_.load(c11::memory_order_relaxed) && ptr) {
+            Record(block_size, ptr, true);
+        }
+    }
+
+    //--------------
+    bool AllocationTrace::Read(const std::string& filename, std::vector<AllocationTraceRecord>& records)
+    {
+        records.clear();
+        std::FILE* file = std::fopen(filename.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        char magic[sizeof(TRACE_MAGIC)];
+        c11::uint32_t version = 0;
+        bool retval = (std::fread(magic, sizeof(magic), 1, file) == 1
+            && std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0
+            && std::fread(&version, sizeof(version), 1, file) == 1
+            && version == TRACE_VERSION);
+        AllocationTraceRecord record;
+        while (retval && std::fread(&record, sizeof(record), 1, file) == 1) {
+            records.push_back(record);
+        }
+        std::fclose(file);
+        return retval;
+    }
+
+    //--------------
+    void AllocationTrace::Record(size_t block_size, void* ptr, bool is_free)
+    {
+        AllocationTraceRecord record;
+        record.address = static_cast<c11::uint64_t>(reinterpret_cast<c11::uintptr_t>(ptr));
+        record.thread_id = GetThreadId();
+        record.block_size_op = static_cast<c11::uint32_t>(block_size);
+        if (is_free) {
+            record.block_size_op |= AllocationTraceRecord::FREE_FLAG;
+        }
+        TraceState& state = GetState();
+        c11::lock_guard<c11::mutex> lock(state.mutex);
+        if (!state.file) { // stopped after recording_ was checked
+            return;
+        }
+        // take the time stamp under the lock, so records are in time order
+        record.timestamp_ns = static_cast<c11::uint64_t>(c11::chrono::duration_cast<c11::chrono::nanoseconds>(
+            c11::chrono::steady_clock::now() - state.start_time).count());
+        state.buffer.push_back(record);
+        if (state.buffer.size() >= BUFFER_SIZE) {
+            Flush(state);
+        }
+    }
+
+} //namespace ldl
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef LDL_ALLOCATION_TRACE_H_
+#define LDL_ALLOCATION_TRACE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// One record of an allocation trace. Records are written to the trace file as-is (24 bytes, native byte order).
+    struct AllocationTraceRecord {
+        // bit set in block_size_op for a free (Push). Otherwise the record is an allocation (Pop).
+        static const c11::uint32_t FREE_FLAG = 0x80000000u;
+
+        // nanoseconds since the trace was started
+        c11::uint64_t timestamp_ns;
+
+        // address of the block. Only used to match frees to allocations.
+        c11::uint64_t address;
+
+        // small id assigned to each thread in the order that it first allocated or freed a block.
+        c11::uint32_t thread_id;
+
+        // block size, or'ed with FREE_FLAG for a free.
+        c11::uint32_t block_size_op;
+
+        // return true if the record is a free.
+        bool IsFree() const { return (block_size_op & FREE_FLAG) != 0; }
+
+        // return the block size of the record.
+        size_t GetBlockSize() const { return static_cast<size_t>(block_size_op & ~FREE_FLAG); }
+    };
+
+    //-------------
+    /// Recorder of a compact binary trace of every block popped from and pushed to StaticPoolList.
+    /// The trace can be replayed offline against different PoolList configurations with AllocationReplay.
+    class AllocationTrace {
+    public:
+
+        // start recording to filename, replacing any trace in progress. Returns false if the file can't be created.
+        static bool Start(const std::string& filename);
+
+        // stop recording, and flush and close the trace file.
+        static void Stop();
+
+        // return true if a trace is being recorded.
+        static bool IsRecording();
+
+        // record an allocation. (called by StaticPoolList::Pop())
+        static void RecordPop(size_t block_size, void* ptr);
+
+        // record a free. (called by StaticPoolList::Push())
+        static void RecordPush(size_t block_size, void* ptr);
+
+        // read the records of a trace file into records. Returns false if the file isn't a valid trace.
+        static bool Read(const std::string& filename, std::vector<AllocationTraceRecord>& records);
+
+    private:
+
+        // append a record to the trace.
+        static void Record(size_t block_size, void* ptr, bool is_free);
+    };
+
+} //namespace ldl
+
+#endif //! LDL_ALLOCATION_TRACE_H_
@@ -0,0 +1,135 @@
+#include "boost/test/unit_test.hpp"
+
+#include "allocation_trace.h"
+#include "allocation_replay.h"
+
+#include "static_pool_list.h"
+
+#include <cstdio> // remove
+
+BOOST_AUTO_TEST_SUITE(ALLOCATION_TRACE)
+BOOST_AUTO_TEST_CASE(allocation_trace_test)
+{
+    BOOST_TEST_MESSAGE("Starting allocation_trace_test");
+
+    try {
+        const char* filename = "allocation_trace_test.trace";
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // nothing is recorded by default
+        BOOST_CHECK(!ldl::AllocationTrace::IsRecording());
+        void* ptr_a = ldl::StaticPoolList::Pop(40);
+        ldl::StaticPoolList::Push(40, ptr_a);
+
+        BOOST_REQUIRE(ldl::AllocationTrace::Start(filename));
+        BOOST_CHECK(ldl::AllocationTrace::IsRecording());
+        void* ptrs[6];
+        for (size_t ix = 0; ix < 4; ++ix) {
+            ptrs[ix] = ldl::StaticPoolList::Pop(40);
+        }
+        ptrs[4] = ldl::StaticPoolList::Pop(56);
+        ptrs[5] = ldl::StaticPoolList::Pop(64);
+        for (size_t ix = 0; ix < 4; ++ix) {
+            ldl::StaticPoolList::Push(40, ptrs[ix]);
+        }
+        ldl::StaticPoolList::Push(56, ptrs[4]);
+        ldl::AllocationTrace::Stop();
+        BOOST_CHECK(!ldl::AllocationTrace::IsRecording());
+        ldl::StaticPoolList::Push(64, ptrs[5]); // not recorded
+
+        std::vector<ldl::AllocationTraceRecord> records;
+        BOOST_REQUIRE(ldl::AllocationTrace::Read(filename, records));
+        std::remove(filename);
+        BOOST_REQUIRE_EQUAL(records.size(), 11);
+        BOOST_CHECK(!records[0].IsFree());
+        BOOST_CHECK_EQUAL(records[0].GetBlockSize(), 40);
+        BOOST_CHECK_EQUAL(records[0].address, reinterpret_cast<c11::uintptr_t>(ptrs[0]));
+        BOOST_CHECK_EQUAL(records[5].GetBlockSize(), 64);
+        BOOST_CHECK(records[6].IsFree());
+        BOOST_CHECK_EQUAL(records[6].GetBlockSize(), 40);
+        BOOST_CHECK_EQUAL(records[6].address, records[0].address);
+        BOOST_CHECK(records[0].timestamp_ns <= records[10].timestamp_ns);
+
+        // one pool per size, grown one block at a time
+        ldl::ReplayConfig config;
+        config.growth_step = 1;
+        ldl::ReplayResult result = ldl::AllocationReplay::Run(records, config);
+        BOOST_CHECK_EQUAL(result.pops, 6);
+        BOOST_CHECK_EQUAL(result.pushes, 5);
+        BOOST_CHECK_EQUAL(result.failed_pops, 0);
+        BOOST_CHECK_EQUAL(result.growth_events, 6);
+        BOOST_CHECK_EQUAL(result.peak_bytes_in_use, 4 * 40 + 56 + 64);
+        BOOST_CHECK_EQUAL(result.peak_bytes_reserved, 4 * 40 + 56 + 64);
+        BOOST_CHECK_EQUAL(result.internal_fragmentation, 0.0);
+
+        // without growth every allocation fails
+        config.growth_step = 0;
+        result = ldl::AllocationReplay::Run(records, config);
+        BOOST_CHECK_EQUAL(result.pops, 0);
+        BOOST_CHECK_EQUAL(result.failed_pops, 6);
+        BOOST_CHECK_EQUAL(result.pushes, 0);
+
+        // preallocating the peak avoids growth
+        config.preallocation = ldl::AllocationReplay::SuggestPreallocation(records, config.size_classes);
+        BOOST_REQUIRE_EQUAL(config.preallocation.size(), 3);
+        BOOST_CHECK_EQUAL(config.preallocation[40], 4);
+        BOOST_CHECK_EQUAL(config.preallocation[56], 1);
+        BOOST_CHECK_EQUAL(config.preallocation[64], 1);
+        result = ldl::AllocationReplay::Run(records, config);
+        BOOST_CHECK_EQUAL(result.pops, 6);
+        BOOST_CHECK_EQUAL(result.failed_pops, 0);
+        BOOST_CHECK_EQUAL(result.growth_events, 0);
+        BOOST_CHECK_EQUAL(result.idle_fraction, 0.0);
+
+        // two size classes: 56 is rounded up to 64 rather than 40 to 56
+        config.size_classes = ldl::AllocationReplay::SuggestSizeClasses(records, 2);
+        BOOST_REQUIRE_EQUAL(config.size_classes.size(), 2);
+        BOOST_CHECK_EQUAL(config.size_classes[0], 40);
+        BOOST_CHECK_EQUAL(config.size_classes[1], 64);
+        config.preallocation = ldl::AllocationReplay::SuggestPreallocation(records, config.size_classes);
+        BOOST_REQUIRE_EQUAL(config.preallocation.size(), 2);
+        BOOST_CHECK_EQUAL(config.preallocation[64], 2);
+        result = ldl::AllocationReplay::Run(records, config);
+        BOOST_CHECK_EQUAL(result.failed_pops, 0);
+        BOOST_CHECK_EQUAL(result.peak_bytes_in_use, 4 * 40 + 2 * 64);
+        BOOST_CHECK_CLOSE(result.internal_fragmentation, 8.0 / (4 * 40 + 2 * 64), 0.001);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in allocation_trace_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(allocation_replay_baseline_test)
+{
+    BOOST_TEST_MESSAGE("Starting allocation_replay_baseline_test");
+
+    try {
+        // small trace: 3 blocks of 32 and 1 of 128 live at once, then all freed
+        const c11::uint64_t addresses[] = { 0x1000, 0x2000, 0x3000, 0x4000 };
+        const c11::uint32_t sizes[] = { 32, 32, 32, 128 };
+        std::vector<ldl::AllocationTraceRecord> records;
+        for (size_t ix = 0; ix < 8; ++ix) {
+            ldl::AllocationTraceRecord record;
+            record.timestamp_ns = ix;
+            record.address = addresses[ix % 4];
+            record.thread_id = 0;
+            record.block_size_op = sizes[ix % 4] | (ix < 4 ? 0 : ldl::AllocationTraceRecord::FREE_FLAG);
+            records.push_back(record);
+        }
+
+        // the default configuration (the baseline of trace_replay) grows on demand, so nothing fails
+        ldl::ReplayConfig config;
+        BOOST_CHECK(config.growth_step != 0);
+        ldl::ReplayResult result = ldl::AllocationReplay::Run(records, config);
+        BOOST_CHECK_EQUAL(result.pops, 4);
+        BOOST_CHECK_EQUAL(result.pushes, 4);
+        BOOST_CHECK_EQUAL(result.failed_pops, 0);
+        BOOST_CHECK(result.growth_events > 0);
+        BOOST_CHECK_EQUAL(result.peak_bytes_in_use, 3 * 32 + 128);
+        BOOST_CHECK(result.peak_bytes_reserved >= result.peak_bytes_in_use);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in allocation_replay_baseline_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
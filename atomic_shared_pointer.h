@@ -0,0 +1,121 @@
+#pragma once
+#ifndef LDL_ATOMIC_SHARED_POINTER_H_
+#define LDL_ATOMIC_SHARED_POINTER_H_
+
+#include "pooled_new.h"
+#include "shared_pointer.h"
+
+#include <atomic>
+#include <cstdint>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Pooled node that holds the value published by an AtomicSharedPointer.
+    template<typename T>
+    struct AtomicSharedNode {
+        // references to the node: one for the AtomicSharedPointer while it is published,
+        // plus the claims of readers that were transferred when it was replaced.
+        c11::atomic<long> refs;
+        SharedPointer<T> value;
+        explicit AtomicSharedNode(const SharedPointer<T>& value);
+        //--
+        static const size_t element_size_;
+#include "pooled_new.inc"
+    };
+
+    //-------------
+    /// A SharedPointer that can be read and replaced by several threads at once without locks,
+    /// for publishing read-mostly data. Readers take a snapshot with load(), and writers publish a new
+    /// version with store() or exchange(). The previous version is deleted when its last reader releases it.
+    ///
+    /// The published value is held in a pooled node. The atomic word holds the node address plus a count of
+    /// readers that are copying the value out of it (split reference counting), so load() is one fetch_add,
+    /// one SharedPointer copy and (usually) one compare-and-swap. At most 65535 threads may be in load() at once.
+    template<typename T>
+    class AtomicSharedPointer {
+    public:
+
+        // Default constructor (holds an empty SharedPointer)
+        AtomicSharedPointer();
+
+        // construct holding value
+        explicit AtomicSharedPointer(const SharedPointer<T>& value);
+
+        // destructor
+        ~AtomicSharedPointer();
+
+        // return a copy of the current value.
+        SharedPointer<T> load() const;
+
+        // replace the current value.
+        void store(const SharedPointer<T>& desired);
+
+        // replace the current value, and return the previous one.
+        SharedPointer<T> exchange(const SharedPointer<T>& desired);
+
+        // if the current value owns the same pointer as expected, replace it with desired and return true.
+        // Otherwise copy the current value to expected and return false.
+        bool compare_exchange_strong(SharedPointer<T>& expected, const SharedPointer<T>& desired);
+
+        // same as compare_exchange_strong(), but may fail spuriously if other threads are reading the value.
+        bool compare_exchange_weak(SharedPointer<T>& expected, const SharedPointer<T>& desired);
+
+        // return true if operations never block. (true if 64 bit atomics are lock-free)
+        bool is_lock_free() const;
+
+        // same as load()
+        operator SharedPointer<T>() const;
+
+        // same as store()
+        AtomicSharedPointer& operator=(const SharedPointer<T>& desired);
+
+    private:
+
+        typedef AtomicSharedNode<T> Node;
+
+        // number of low bits of word_ that hold the node address. The remaining bits count the readers.
+        static const unsigned POINTER_BITS = (sizeof(void*) == 8) ? 48 : 32;
+
+        // one reader in word_.
+        static const c11::uint64_t ONE_READER = c11::uint64_t(1) << POINTER_BITS;
+
+        // return the node address in word.
+        static Node* GetNode(c11::uint64_t word);
+
+        // return the number of readers in word.
+        static long GetReaders(c11::uint64_t word);
+
+        // return a pointer to a new node holding value, or 0 if value is empty.
+        static Node* CreateNode(const SharedPointer<T>& value);
+
+        // remove one reference to node, and delete it if it was the last one.
+        static void ReleaseNode(Node* node);
+
+        // add a reader to word_, so the current node can't be deleted. Returns the node.
+        Node* Claim() const;
+
+        // remove the reader added by Claim().
+        void Unclaim(Node* node) const;
+
+        // release the reference of a node that was replaced in word_ by a writer.
+        // readers is the number of readers that were in word_, of which own_claims are held by the caller.
+        static void Retire(Node* node, long readers, long own_claims);
+
+        //---
+
+        // node address and reader count
+        mutable c11::atomic<c11::uint64_t> word_;
+
+        AtomicSharedPointer(const AtomicSharedPointer&) = delete;
+        AtomicSharedPointer& operator=(const AtomicSharedPointer&) = delete;
+    };
+
+} //namespace ldl
+
+#include "atomic_shared_pointer.hpp"
+
+#endif //! LDL_ATOMIC_SHARED_POINTER_H_
@@ -0,0 +1,203 @@
+#include "atomic_shared_pointer.h"
+
+namespace ldl {
+
+    //---------------
+    template<typename T>
+    AtomicSharedNode<T>::AtomicSharedNode(const SharedPointer<T>& value)
+        : refs(1)
+        , value(value)
+    {
+    }
+
+    //---------------
+    template<typename T>
+    const size_t AtomicSharedNode<T>::element_size_ = sizeof(AtomicSharedNode<T>);
+
+    //==========================
+
+    //---------------
+    template<typename T>
+    AtomicSharedPointer<T>::AtomicSharedPointer()
+        : word_(0)
+    {
+    }
+
+    //---------------
+    template<typename T>
+    AtomicSharedPointer<T>::AtomicSharedPointer(const SharedPointer<T>& value)
+        : word_(reinterpret_cast<c11::uintptr_t>(CreateNode(value)))
+    {
+    }
+
+    //---------------
+    template<typename T>
+    AtomicSharedPointer<T>::~AtomicSharedPointer()
+    {
+        // no other thread can be using *this
+        ReleaseNode(GetNode(word_.load(c11::memory_order_acquire)));
+    }
+
+    //---------------
+    template<typename T>
+    SharedPointer<T> AtomicSharedPointer<T>::load() const
+    {
+        SharedPointer<T> retval;
+        Node* node = Claim();
+        if (node) {
+            retval = node->value;
+        }
+        Unclaim(node);
+        return retval;
+    }
+
+    //---------------
+    template<typename T>
+    void AtomicSharedPointer<T>::store(const SharedPointer<T>& desired)
+    {
+        Node* new_node = CreateNode(desired);
+        c11::uint64_t old_word = word_.exchange(reinterpret_cast<c11::uintptr_t>(new_node), c11::memory_order_acq_rel);
+        Retire(GetNode(old_word), GetReaders(old_word), 0);
+    }
+
+    //---------------
+    template<typename T>
+    SharedPointer<T> AtomicSharedPointer<T>::exchange(const SharedPointer<T>& desired)
+    {
+        Node* new_node = CreateNode(desired);
+        c11::uint64_t old_word = word_.exchange(reinterpret_cast<c11::uintptr_t>(new_node), c11::memory_order_acq_rel);
+        Node* old_node = GetNode(old_word);
+        SharedPointer<T> retval;
+        if (old_node) {
+            retval = old_node->value; // copy (readers may still be copying it too)
+        }
+        Retire(old_node, GetReaders(old_word), 0);
+        return retval;
+    }
+
+    //---------------
+    template<typename T>
+    bool AtomicSharedPointer<T>::compare_exchange_strong(SharedPointer<T>& expected, const SharedPointer<T>& desired)
+    {
+        while (true) {
+            Node* node = Claim();
+            SharedPointer<T> current;
+            if (node) {
+                current = node->value;
+            }
+            if (current.get() != expected.get() || current.control_ptr_ != expected.control_ptr_) {
+                Unclaim(node);
+                expected = current;
+                return false;
+            }
+            // try to replace node while it is still current
+            Node* new_node = CreateNode(desired);
+            c11::uint64_t word = word_.load(c11::memory_order_relaxed);
+            while (GetNode(word) == node) {
+                if (word_.compare_exchange_weak(word, reinterpret_cast<c11::uintptr_t>(new_node),
+                    c11::memory_order_acq_rel, c11::memory_order_relaxed)) {
+                    Retire(node, GetReaders(word), node ? 1 : 0);
+                    return true;
+                }
+            }
+            // another writer replaced node first. try again with the new value.
+            ReleaseNode(new_node);
+            Unclaim(node);
+        }
+    }
+
+    //---------------
+    template<typename T>
+    bool AtomicSharedPointer<T>::compare_exchange_weak(SharedPointer<T>& expected, const SharedPointer<T>& desired)
+    {
+        return compare_exchange_strong(expected, desired);
+    }
+
+    //---------------
+    template<typename T>
+    bool AtomicSharedPointer<T>::is_lock_free() const
+    {
+        return word_.is_lock_free();
+    }
+
+    //---------------
+    template<typename T>
+    AtomicSharedPointer<T>::operator SharedPointer<T>() const
+    {
+        return load();
+    }
+
+    //---------------
+    template<typename T>
+    AtomicSharedPointer<T>& AtomicSharedPointer<T>::operator=(const SharedPointer<T>& desired)
+    {
+        store(desired);
+        return *this;
+    }
+
+    //---------------
+    template<typename T>
+    typename AtomicSharedPointer<T>::Node* AtomicSharedPointer<T>::GetNode(c11::uint64_t word)
+    {
+        return reinterpret_cast<Node*>(static_cast<c11::uintptr_t>(word & (ONE_READER - 1)));
+    }
+
+    //---------------
+    template<typename T>
+    long AtomicSharedPointer<T>::GetReaders(c11::uint64_t word)
+    {
+        return static_cast<long>(word >> POINTER_BITS);
+    }
+
+    //---------------
+    template<typename T>
+    typename AtomicSharedPointer<T>::Node* AtomicSharedPointer<T>::CreateNode(const SharedPointer<T>& value)
+    {
+        return value ? new Node(value) : 0;
+    }
+
+    //---------------
+    template<typename T>
+    void AtomicSharedPointer<T>::ReleaseNode(Node* node)
+    {
+        if (node && node->refs.fetch_sub(1, c11::memory_order_acq_rel) == 1) {
+            delete node;
+        }
+    }
+
+    //---------------
+    template<typename T>
+    typename AtomicSharedPointer<T>::Node* AtomicSharedPointer<T>::Claim() const
+    {
+        return GetNode(word_.fetch_add(ONE_READER, c11::memory_order_acquire));
+    }
+
+    //---------------
+    template<typename T>
+    void AtomicSharedPointer<T>::Unclaim(Node* node) const
+    {
+        c11::uint64_t word = word_.load(c11::memory_order_relaxed);
+        // if node is still current, remove the claim from word_. (if node is 0, the count may have been discarded)
+        while (GetNode(word) == node && GetReaders(word) > 0) {
+            if (word_.compare_exchange_weak(word, word - ONE_READER, c11::memory_order_release, c11::memory_order_relaxed)) {
+                return;
+            }
+        }
+        // node was replaced, and the claim was transferred to its reference count.
+        ReleaseNode(node);
+    }
+
+    //---------------
+    template<typename T>
+    void AtomicSharedPointer<T>::Retire(Node* node, long readers, long own_claims)
+    {
+        if (node) {
+            // drop the reference of word_ and own_claims, and add one for each reader still copying the value.
+            long delta = readers - own_claims - 1;
+            if (node->refs.fetch_add(delta, c11::memory_order_acq_rel) + delta == 0) {
+                delete node;
+            }
+        }
+    }
+
+} //namespace ldl
@@ -0,0 +1,91 @@
+#include "boost/test/unit_test.hpp"
+
+#include "atomic_shared_pointer.h"
+
+#include "shared_pointer.h"
+#include "static_pool_list.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(ATOMIC_SHARED_POINTER)
+BOOST_AUTO_TEST_CASE(atomic_shared_pointer_test)
+{
+    BOOST_TEST_MESSAGE("Starting atomic_shared_pointer_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // default constructor
+        ldl::AtomicSharedPointer<int> a1;
+        BOOST_CHECK_EQUAL((bool)a1.load(), false);
+
+        // store, load
+        ldl::SharedPointer<int> s1(new int(1));
+        a1.store(s1);
+        BOOST_CHECK_EQUAL(a1.load().get(), s1.get());
+        BOOST_CHECK_EQUAL(s1.use_count(), 2);
+
+        // exchange
+        ldl::SharedPointer<int> s2 = ldl::MakeShared<int>(2);
+        ldl::SharedPointer<int> old = a1.exchange(s2);
+        BOOST_CHECK_EQUAL(old.get(), s1.get());
+        BOOST_CHECK_EQUAL(s1.use_count(), 2); // s1 and old
+        old.reset();
+        BOOST_CHECK_EQUAL(s1.use_count(), 1);
+        BOOST_CHECK_EQUAL(*a1.load(), 2);
+
+        // compare_exchange
+        ldl::SharedPointer<int> expected = s1;
+        BOOST_CHECK_EQUAL(a1.compare_exchange_strong(expected, s1), false);
+        BOOST_CHECK_EQUAL(expected.get(), s2.get());
+        BOOST_CHECK_EQUAL(a1.compare_exchange_strong(expected, s1), true);
+        BOOST_CHECK_EQUAL(a1.load().get(), s1.get());
+
+        // empty values
+        a1.store(ldl::SharedPointer<int>());
+        BOOST_CHECK_EQUAL((bool)a1.load(), false);
+        BOOST_CHECK_EQUAL(s1.use_count(), 1);
+        expected.reset();
+        BOOST_CHECK_EQUAL(a1.compare_exchange_strong(expected, s2), true);
+        BOOST_CHECK_EQUAL(*a1.load(), 2);
+
+        // readers see complete versions while a writer publishes new ones
+        {
+            const int num_versions = 2000;
+            ldl::AtomicSharedPointer<int> a2(ldl::MakeShared<int>(0));
+            std::atomic<bool> done(false);
+            std::atomic<int> errors(0);
+            std::vector<std::thread> readers;
+            for (size_t ix = 0; ix < 3; ++ix) {
+                readers.push_back(std::thread([&a2, &done, &errors]() {
+                    int last = 0;
+                    while (!done.load()) {
+                        ldl::SharedPointer<int> snapshot = a2.load();
+                        if (!snapshot || *snapshot < last) {
+                            ++errors;
+                        }
+                        else {
+                            last = *snapshot;
+                        }
+                    }
+                }));
+            }
+            for (int version = 1; version <= num_versions; ++version) {
+                a2.store(ldl::MakeShared<int>(version));
+            }
+            done.store(true);
+            for (size_t ix = 0; ix < readers.size(); ++ix) {
+                readers[ix].join();
+            }
+            BOOST_CHECK_EQUAL(errors.load(), 0);
+            BOOST_CHECK_EQUAL(*a2.load(), num_versions);
+            BOOST_CHECK_EQUAL(a2.load().use_count(), 2);
+        }
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in atomic_shared_pointer_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
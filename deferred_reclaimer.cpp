@@ -0,0 +1,205 @@
+#include "deferred_reclaimer.h"
+
+#include <cstdlib> // atexit
+
+namespace ldl {
+
+    //--------------
+    Reclaimable::Reclaimable()
+        : next_reclaimable_(0)
+    {
+    }
+
+    //--------------
+    Reclaimable::~Reclaimable()
+    {
+    }
+
+    //==========================
+
+    const size_t DeferredReclaimer::DEFAULT_MAX_BACKLOG;
+    const int DeferredReclaimer::POLL_PERIOD_MS; // bound to a reference by chrono::milliseconds
+
+    c11::atomic<Reclaimable*> DeferredReclaimer::head_(0);
+    c11::atomic<size_t> DeferredReclaimer::backlog_(0);
+    c11::atomic<size_t> DeferredReclaimer::max_backlog_(0);
+    c11::atomic<bool> DeferredReclaimer::running_(false);
+    c11::atomic<size_t> DeferredReclaimer::reclaimed_count_(0);
+    c11::atomic<size_t> DeferredReclaimer::overflow_count_(0);
+    c11::mutex DeferredReclaimer::mutex_;
+    c11::condition_variable DeferredReclaimer::cv_;
+    c11::condition_variable DeferredReclaimer::flush_cv_;
+    bool DeferredReclaimer::stop_ = false;
+    size_t DeferredReclaimer::flush_requests_ = 0;
+    size_t DeferredReclaimer::flushes_done_ = 0;
+    c11::thread DeferredReclaimer::thread_;
+
+    namespace {
+
+        //--------------
+        // stop the reclaimer thread at exit, so queued objects are destroyed and the thread is joined.
+        // Registered with atexit() by the first Start(), so it runs before the destructors of static objects
+        // that were constructed before that call, e.g. the StaticPoolList pools that queued objects are freed into.
+        // (a static object destructor here would run in an unspecified order with those of other source files)
+        void StopAtExit()
+        {
+            DeferredReclaimer::Stop();
+        }
+
+        // makes sure StopAtExit() is registered once
+        c11::once_flag stop_at_exit_flag;
+
+    } // namespace
+
+    //--------------
+    void DeferredReclaimer::Start(size_t max_backlog)
+    {
+        c11::call_once(stop_at_exit_flag, [] { std::atexit(StopAtExit); });
+        Stop();
+        {
+            c11::lock_guard<c11::mutex> lock(mutex_);
+            stop_ = false;
+            flush_requests_ = 0;
+            flushes_done_ = 0;
+        }
+        reclaimed_count_.store(0);
+        overflow_count_.store(0);
+        max_backlog_.store(max_backlog);
+        thread_ = c11::thread(&DeferredReclaimer::Run);
+        running_.store(true);
+    }
+
+    //--------------
+    void DeferredReclaimer::Stop()
+    {
+        if (!thread_.joinable()) {
+            return;
+        }
+        running_.store(false);
+        {
+            c11::lock_guard<c11::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+        // reclaim objects that Defer() calls reserved room for before running_ was cleared.
+        while (backlog_.load() != 0) {
+            if (ReclaimAll() == 0) {
+                c11::this_thread::yield();
+            }
+        }
+    }
+
+    //--------------
+    bool DeferredReclaimer::IsRunning()
+    {
+        return running_.load();
+    }
+
+    //--------------
+    void DeferredReclaimer::Flush()
+    {
+        c11::unique_lock<c11::mutex> lock(mutex_);
+        if (!running_.load() || stop_) { // queue is emptied by Stop()
+            return;
+        }
+        size_t request = ++flush_requests_;
+        cv_.notify_one();
+        flush_cv_.wait(lock, [request] { return flushes_done_ >= request; });
+    }
+
+    //--------------
+    bool DeferredReclaimer::Defer(Reclaimable* ptr)
+    {
+        // reserve room in the backlog before checking running_, so Stop() waits for ptr to be queued.
+        size_t backlog = backlog_.fetch_add(1);
+        if (!running_.load()) {
+            backlog_.fetch_sub(1);
+            return false;
+        }
+        if (backlog >= max_backlog_.load(c11::memory_order_relaxed)) {
+            backlog_.fetch_sub(1);
+            overflow_count_.fetch_add(1, c11::memory_order_relaxed);
+            return false;
+        }
+        // push ptr. (only the thread pops, and it takes the whole stack, so there is no ABA problem)
+        Reclaimable* head = head_.load(c11::memory_order_relaxed);
+        do {
+            ptr->next_reclaimable_ = head;
+        } while (!head_.compare_exchange_weak(head, ptr, c11::memory_order_release, c11::memory_order_relaxed));
+        if (head == 0) {
+            // wake the thread when the queue becomes non-empty. (a missed wake-up is caught by POLL_PERIOD_MS)
+            cv_.notify_one();
+        }
+        return true;
+    }
+
+    //--------------
+    size_t DeferredReclaimer::GetBacklog()
+    {
+        return backlog_.load(c11::memory_order_relaxed);
+    }
+
+    //--------------
+    size_t DeferredReclaimer::GetReclaimedCount()
+    {
+        return reclaimed_count_.load(c11::memory_order_relaxed);
+    }
+
+    //--------------
+    size_t DeferredReclaimer::GetOverflowCount()
+    {
+        return overflow_count_.load(c11::memory_order_relaxed);
+    }
+
+    //--------------
+    void DeferredReclaimer::Run()
+    {
+        c11::unique_lock<c11::mutex> lock(mutex_);
+        while (true) {
+            size_t flush_request = flush_requests_;
+            bool stop = stop_;
+            lock.unlock(); // don't block Defer() wake-ups or Flush() while reclaiming
+            while (ReclaimAll() != 0) {
+            }
+            lock.lock();
+            if (flushes_done_ != flush_request) {
+                flushes_done_ = flush_request;
+                flush_cv_.notify_all();
+            }
+            if (stop) {
+                break;
+            }
+            cv_.wait_for(lock, c11::chrono::milliseconds(POLL_PERIOD_MS), [] {
+                return stop_ || flush_requests_ != flushes_done_ || head_.load(c11::memory_order_relaxed) != 0;
+            });
+        }
+    }
+
+    //--------------
+    size_t DeferredReclaimer::ReclaimAll()
+    {
+        Reclaimable* stack = head_.exchange(0, c11::memory_order_acquire);
+        // reverse the stack, so objects are reclaimed in the order they were queued.
+        Reclaimable* queue = 0;
+        while (stack) {
+            Reclaimable* next = stack->next_reclaimable_;
+            stack->next_reclaimable_ = queue;
+            queue = stack;
+            stack = next;
+        }
+        size_t count = 0;
+        while (queue) {
+            Reclaimable* next = queue->next_reclaimable_;
+            queue->Reclaim(); // may queue more objects
+            queue = next;
+            ++count;
+        }
+        if (count) {
+            backlog_.fetch_sub(count);
+            reclaimed_count_.fetch_add(count, c11::memory_order_relaxed);
+        }
+        return count;
+    }
+
+} //namespace ldl
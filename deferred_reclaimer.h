@@ -0,0 +1,134 @@
+#pragma once
+#ifndef LDL_DEFERRED_RECLAIMER_H_
+#define LDL_DEFERRED_RECLAIMER_H_
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Base class of objects whose destruction can be handed to the DeferredReclaimer thread.
+    /// Holds the link of the reclaimer queue, so queueing an object doesn't allocate.
+    class Reclaimable {
+    public:
+
+        // destroy the object. (called by the DeferredReclaimer thread)
+        virtual void Reclaim() = 0;
+
+    protected:
+
+        // constructor
+        Reclaimable();
+
+        // destructor
+        ~Reclaimable();
+
+    private:
+        friend class DeferredReclaimer;
+
+        // next object in the reclaimer queue
+        Reclaimable* next_reclaimable_;
+    };
+
+    //-------------
+    /// Background thread that destroys objects released by latency-critical threads. (see DeferredCountPolicy)
+    /// Defer() pushes an object onto a lock-free stack with one compare-and-swap, and the thread reclaims the
+    /// objects in the order they were queued. The number of queued objects is bounded: when the backlog is full,
+    /// or the thread isn't running, Defer() returns false and the caller must reclaim the object itself.
+    class DeferredReclaimer {
+    public:
+
+        // default value of max_backlog
+        static const size_t DEFAULT_MAX_BACKLOG = 65536;
+
+        // interval at which the thread checks the queue if it misses a wake-up
+        static const int POLL_PERIOD_MS = 10;
+
+        // start the reclaimer thread. At most max_backlog objects may be waiting to be reclaimed.
+        // Restarts the thread if it is already running.
+        // The thread is stopped at exit, before static objects constructed before the first Start() are destroyed,
+        // so call Start() from main(). If it is called during static initialization, call Stop() before main() returns.
+        static void Start(size_t max_backlog = DEFAULT_MAX_BACKLOG);
+
+        // reclaim all queued objects, and stop the thread. Objects released later are reclaimed inline.
+        static void Stop();
+
+        // return true if the reclaimer thread is running.
+        static bool IsRunning();
+
+        // wait until all objects that were queued before the call have been reclaimed.
+        static void Flush();
+
+        // queue ptr to be reclaimed by the thread. Lock-free.
+        // Returns false if the thread isn't running or the backlog is full, in which case ptr was not queued.
+        static bool Defer(Reclaimable* ptr);
+
+        // return the number of objects waiting to be reclaimed.
+        static size_t GetBacklog();
+
+        // return the number of objects reclaimed by the thread since Start().
+        static size_t GetReclaimedCount();
+
+        // return the number of Defer() calls refused because the backlog was full, since Start().
+        static size_t GetOverflowCount();
+
+    private:
+
+        // body of the reclaimer thread.
+        static void Run();
+
+        // reclaim all objects that are in the queue. Returns the number of objects reclaimed.
+        static size_t ReclaimAll();
+
+        //---
+
+        // top of the stack of queued objects
+        static c11::atomic<Reclaimable*> head_;
+
+        // number of objects queued, or being queued by Defer()
+        static c11::atomic<size_t> backlog_;
+
+        // maximum value of backlog_
+        static c11::atomic<size_t> max_backlog_;
+
+        // true while Defer() may queue objects
+        static c11::atomic<bool> running_;
+
+        // number of objects reclaimed since Start()
+        static c11::atomic<size_t> reclaimed_count_;
+
+        // number of Defer() calls refused because the backlog was full
+        static c11::atomic<size_t> overflow_count_;
+
+        // protects stop_, flush_requests_ and flushes_done_
+        static c11::mutex mutex_;
+
+        // used to wake the thread when objects are queued, or by Flush() and Stop()
+        static c11::condition_variable cv_;
+
+        // used to wake Flush() when the thread has emptied the queue
+        static c11::condition_variable flush_cv_;
+
+        // true when the thread has been asked to exit.
+        static bool stop_;
+
+        // number of Flush() calls
+        static size_t flush_requests_;
+
+        // number of Flush() calls that have been completed by the thread
+        static size_t flushes_done_;
+
+        // reclaimer thread
+        static c11::thread thread_;
+    };
+
+} //namespace ldl
+
+#endif //! LDL_DEFERRED_RECLAIMER_H_
@@ -0,0 +1,98 @@
+#include "boost/test/unit_test.hpp"
+
+#include "deferred_reclaimer.h"
+
+#include "shared_pointer.h"
+#include "static_pool_list.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    std::atomic<int> destroyed_count(0);
+
+    // object that records the thread that destroyed it
+    struct Graph {
+        explicit Graph(std::thread::id* destroyer) : destroyer(destroyer) {}
+        ~Graph() {
+            if (destroyer) {
+                *destroyer = std::this_thread::get_id();
+            }
+            ++destroyed_count;
+        }
+        std::thread::id* destroyer;
+    };
+
+} //namespace
+
+BOOST_AUTO_TEST_SUITE(DEFERRED_RECLAIMER)
+
+BOOST_AUTO_TEST_CASE(deferred_reclaimer_test)
+{
+    BOOST_TEST_MESSAGE("Starting deferred_reclaimer_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+        destroyed_count = 0;
+
+        // destroyed inline if the reclaimer isn't running
+        std::thread::id destroyer;
+        ldl::DeferredSharedPointer<Graph> s1(new Graph(&destroyer));
+        s1.reset();
+        BOOST_CHECK_EQUAL(destroyed_count.load(), 1);
+        BOOST_CHECK(destroyer == std::this_thread::get_id());
+
+        // destroyed by the reclaimer thread
+        ldl::DeferredReclaimer::Start();
+        BOOST_CHECK_EQUAL(ldl::DeferredReclaimer::IsRunning(), true);
+        ldl::DeferredSharedPointer<Graph> s2 = ldl::MakeBasicShared<Graph, ldl::DeferredCountPolicy>(&destroyer);
+        ldl::DeferredSharedPointer<Graph> s3(s2);
+        s2.reset();
+        BOOST_CHECK_EQUAL(destroyed_count.load(), 1); // s3 still owns it
+        s3.reset();
+        ldl::DeferredReclaimer::Flush();
+        BOOST_CHECK_EQUAL(destroyed_count.load(), 2);
+        BOOST_CHECK(destroyer != std::this_thread::get_id());
+        BOOST_CHECK_EQUAL(ldl::DeferredReclaimer::GetReclaimedCount(), 1u);
+        BOOST_CHECK_EQUAL(ldl::DeferredReclaimer::GetBacklog(), 0u);
+
+        // releases from several threads
+        std::vector<std::thread> threads;
+        for (size_t ix = 0; ix < 4; ++ix) {
+            threads.push_back(std::thread([]() {
+                for (size_t jx = 0; jx < 1000; ++jx) {
+                    ldl::DeferredSharedPointer<Graph> s(new Graph(0));
+                    ldl::DeferredSharedPointer<Graph> copy(s);
+                }
+            }));
+        }
+        for (size_t ix = 0; ix < threads.size(); ++ix) {
+            threads[ix].join();
+        }
+        ldl::DeferredReclaimer::Flush();
+        BOOST_CHECK_EQUAL(destroyed_count.load(), 4002);
+
+        // Stop() reclaims queued objects
+        ldl::DeferredSharedPointer<Graph> s4(new Graph(0));
+        s4.reset();
+        ldl::DeferredReclaimer::Stop();
+        BOOST_CHECK_EQUAL(ldl::DeferredReclaimer::IsRunning(), false);
+        BOOST_CHECK_EQUAL(destroyed_count.load(), 4003);
+        BOOST_CHECK_EQUAL(ldl::DeferredReclaimer::GetBacklog(), 0u);
+
+        // destroyed inline when the backlog is full
+        ldl::DeferredReclaimer::Start(0);
+        ldl::DeferredSharedPointer<Graph> s5(new Graph(&destroyer));
+        s5.reset();
+        BOOST_CHECK_EQUAL(destroyed_count.load(), 4004);
+        BOOST_CHECK(destroyer == std::this_thread::get_id());
+        BOOST_CHECK_EQUAL(ldl::DeferredReclaimer::GetOverflowCount(), 1u);
+        ldl::DeferredReclaimer::Stop();
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in deferred_reclaimer_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,34 @@
+#include "executor.h"
+
+namespace ldl {
+
+    //--------------
+    ExecutorTask::ExecutorTask()
+        : next_task_(0)
+    {
+    }
+
+    //--------------
+    ExecutorTask::~ExecutorTask()
+    {
+    }
+
+    //--------------
+    Executor::~Executor()
+    {
+    }
+
+    //--------------
+    void InlineExecutor::Execute(ExecutorTask* task)
+    {
+        task->Run();
+    }
+
+    //--------------
+    InlineExecutor& InlineExecutor::Instance()
+    {
+        static InlineExecutor instance;
+        return instance;
+    }
+
+} //namespace ldl
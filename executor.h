@@ -0,0 +1,57 @@
+#pragma once
+#ifndef LDL_EXECUTOR_H_
+#define LDL_EXECUTOR_H_
+
+namespace ldl {
+
+    //-------------
+    /// Unit of work that can be handed to an Executor. Tasks are usually pooled objects that delete themselves
+    /// at the end of Run(), so scheduling work doesn't need std::function or a heap allocation.
+    class ExecutorTask {
+    public:
+
+        // do the work. The executor doesn't use the task after calling Run(), so Run() may delete it.
+        virtual void Run() = 0;
+
+    protected:
+
+        // constructor
+        ExecutorTask();
+
+        // destructor
+        virtual ~ExecutorTask();
+
+    private:
+        friend class ThreadPool;
+
+        // next task in a ThreadPool inbox
+        ExecutorTask* next_task_;
+    };
+
+    //-------------
+    /// Interface of objects that run ExecutorTask objects. (see InlineExecutor, ThreadPool)
+    class Executor {
+    public:
+
+        // destructor
+        virtual ~Executor();
+
+        // run task, now or later, on this thread or another one. Takes ownership of task.
+        virtual void Execute(ExecutorTask* task) = 0;
+    };
+
+    //-------------
+    /// Executor that runs each task immediately on the thread that calls Execute().
+    class InlineExecutor : public Executor {
+    public:
+
+        // call task->Run().
+        virtual void Execute(ExecutorTask* task);
+
+        // return a shared instance.
+        static InlineExecutor& Instance();
+    };
+
+} //namespace ldl
+
+#endif //! LDL_EXECUTOR_H_
@@ -0,0 +1,131 @@
+#include "futex.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h> // WaitOnAddress
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <linux/futex.h> // FUTEX_WAIT_PRIVATE
+#include <sys/syscall.h> // SYS_futex
+#include <unistd.h> // syscall
+#include <cerrno>
+#include <ctime> // timespec
+#include <climits> // INT_MAX
+#else
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#endif
+
+namespace ldl {
+
+    namespace {
+
+#if !defined(_WIN32) && !defined(__linux__)
+        //--------------
+        // portable fallback: waiters block on a condition variable chosen by the address of the word.
+        struct ParkingBucket {
+            c11::mutex mutex;
+            c11::condition_variable cv;
+        };
+
+        //--------------
+        // return the bucket used for word.
+        ParkingBucket& GetBucket(const Futex::Word& word)
+        {
+            static const size_t NUM_BUCKETS = 64;
+            static ParkingBucket buckets[NUM_BUCKETS];
+            return buckets[(reinterpret_cast<c11::uintptr_t>(&word) >> 4) % NUM_BUCKETS];
+        }
+#endif
+
+#ifdef __linux__
+        //--------------
+        // call futex() on word.
+        long CallFutex(Futex::Word& word, int op, c11::uint32_t value, const timespec* timeout)
+        {
+            return syscall(SYS_futex, reinterpret_cast<c11::uint32_t*>(&word), op, value, timeout, 0, 0);
+        }
+#endif
+
+    } // namespace
+
+    //--------------
+    void Futex::Wait(Word& word, c11::uint32_t expected)
+    {
+#ifdef _WIN32
+        WaitOnAddress(&word, &expected, sizeof(expected), INFINITE);
+#elif defined(__linux__)
+        CallFutex(word, FUTEX_WAIT_PRIVATE, expected, 0);
+#else
+        ParkingBucket& bucket = GetBucket(word);
+        c11::unique_lock<c11::mutex> lock(bucket.mutex);
+        if (word.load() == expected) {
+            bucket.cv.wait(lock);
+        }
+#endif
+    }
+
+    //--------------
+    bool Futex::WaitFor(Word& word, c11::uint32_t expected, c11::chrono::nanoseconds timeout)
+    {
+        if (timeout.count() <= 0) {
+            return false;
+        }
+#ifdef _WIN32
+        // round up to whole milliseconds, so a short wait doesn't become a poll.
+        long long ms = (timeout.count() + 999999) / 1000000;
+        DWORD ms_arg = (ms >= static_cast<long long>(INFINITE)) ? INFINITE - 1 : static_cast<DWORD>(ms);
+        if (!WaitOnAddress(&word, &expected, sizeof(expected), ms_arg)) {
+            return (GetLastError() != ERROR_TIMEOUT);
+        }
+        return true;
+#elif defined(__linux__)
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+        if (CallFutex(word, FUTEX_WAIT_PRIVATE, expected, &ts) != 0) {
+            return (errno != ETIMEDOUT);
+        }
+        return true;
+#else
+        ParkingBucket& bucket = GetBucket(word);
+        c11::unique_lock<c11::mutex> lock(bucket.mutex);
+        if (word.load() == expected) {
+            return (bucket.cv.wait_for(lock, timeout) == c11::cv_status::no_timeout);
+        }
+        return true;
+#endif
+    }
+
+    //--------------
+    void Futex::WakeOne(Word& word)
+    {
+#ifdef _WIN32
+        WakeByAddressSingle(&word);
+#elif defined(__linux__)
+        CallFutex(word, FUTEX_WAKE_PRIVATE, 1, 0);
+#else
+        // other words may share the bucket, so wake all of its waiters.
+        WakeAll(word);
+#endif
+    }
+
+    //--------------
+    void Futex::WakeAll(Word& word)
+    {
+#ifdef _WIN32
+        WakeByAddressAll(&word);
+#elif defined(__linux__)
+        CallFutex(word, FUTEX_WAKE_PRIVATE, INT_MAX, 0);
+#else
+        ParkingBucket& bucket = GetBucket(word);
+        {
+            // the waker changed word before calling WakeAll(); taking the lock orders that with the waiter's check.
+            c11::lock_guard<c11::mutex> lock(bucket.mutex);
+        }
+        bucket.cv.notify_all();
+#endif
+    }
+
+} //namespace ldl
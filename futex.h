@@ -0,0 +1,55 @@
+#pragma once
+#ifndef LDL_FUTEX_H_
+#define LDL_FUTEX_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Functions that block a thread on the value of a 32 bit atomic word, and wake threads blocked on it.
+    /// Uses futex() on Linux and WaitOnAddress() on Windows, so a word that nobody waits on costs nothing,
+    /// and waking a word that has no waiters is a single system call that returns immediately.
+    class Futex {
+    public:
+
+        /// Type of a word that threads can wait on.
+        typedef c11::atomic<c11::uint32_t> Word;
+
+        // block while word == expected, until woken by WakeOne() or WakeAll().
+        // May return spuriously, so callers must check the value of word again.
+        static void Wait(Word& word, c11::uint32_t expected);
+
+        // same as Wait(), but returns false if timeout elapses first.
+        static bool WaitFor(Word& word, c11::uint32_t expected, c11::chrono::nanoseconds timeout);
+
+        // same as Wait(), but returns false if abs_time is reached first.
+        template<typename Clock, typename Duration>
+        static bool WaitUntil(Word& word, c11::uint32_t expected, const c11::chrono::time_point<Clock, Duration>& abs_time);
+
+        // wake one thread blocked on word.
+        static void WakeOne(Word& word);
+
+        // wake all threads blocked on word.
+        static void WakeAll(Word& word);
+    };
+
+    //-----------------
+    template<typename Clock, typename Duration>
+    bool Futex::WaitUntil(Word& word, c11::uint32_t expected, const c11::chrono::time_point<Clock, Duration>& abs_time)
+    {
+        typename Clock::time_point now = Clock::now();
+        if (now >= abs_time) {
+            return false;
+        }
+        return WaitFor(word, expected, c11::chrono::duration_cast<c11::chrono::nanoseconds>(abs_time - now));
+    }
+
+} //namespace ldl
+
+#endif //! LDL_FUTEX_H_
@@ -0,0 +1,56 @@
+#include "boost/test/unit_test.hpp"
+
+#include "futex.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(FUTEX)
+
+BOOST_AUTO_TEST_CASE(futex_test)
+{
+    BOOST_TEST_MESSAGE("Starting futex_test");
+
+    try {
+        ldl::Futex::Word word(0);
+
+        // returns immediately if word doesn't hold the expected value
+        ldl::Futex::Wait(word, 1);
+        BOOST_CHECK_EQUAL(ldl::Futex::WaitFor(word, 1, std::chrono::milliseconds(100)), true);
+
+        // times out if nobody wakes it
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        BOOST_CHECK_EQUAL(ldl::Futex::WaitFor(word, 0, std::chrono::milliseconds(20)), false);
+        BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(15));
+        BOOST_CHECK_EQUAL(ldl::Futex::WaitUntil(word, 0, std::chrono::steady_clock::now() - std::chrono::seconds(1)), false);
+
+        // waking with nobody waiting is harmless
+        ldl::Futex::WakeOne(word);
+        ldl::Futex::WakeAll(word);
+
+        // wake all waiters
+        std::atomic<int> woken(0);
+        std::vector<std::thread> threads;
+        for (size_t ix = 0; ix < 4; ++ix) {
+            threads.push_back(std::thread([&word, &woken]() {
+                while (word.load() == 0) {
+                    ldl::Futex::Wait(word, 0);
+                }
+                ++woken;
+            }));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        word.store(1);
+        ldl::Futex::WakeAll(word);
+        for (size_t ix = 0; ix < threads.size(); ++ix) {
+            threads[ix].join();
+        }
+        BOOST_CHECK_EQUAL(woken.load(), 4);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in futex_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
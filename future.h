@@ -5,10 +5,17 @@
 #include "pooled_new.h"
 #include "shared_pointer.h"
 #include "linkable.h"
+#include "futex.h"
+#include "spin_wait.h"
+#include "executor.h"
 
-#include <mutex>
-#include <condition_variable>
 #include <chrono>
+#include <cstdint>
+#include <exception> // exception_ptr
+#include <future> // future_errc
+#include <system_error> // error_code
+#include <type_traits> // decay, aligned_union
+#include <utility> // declval, move
 namespace c11 {
     using namespace std;
 }
@@ -25,39 +32,196 @@ namespace ldl {
     };
 
     //-------------
+    /// Task attached to a FutureState by Future::then(). It is handed to its Executor when the value is set.
+    class FutureContinuation : public ExecutorTask {
+    public:
+
+        // constructor. The task will run on executor.
+        explicit FutureContinuation(Executor& executor);
+
+        // hand this task to its executor.
+        void Schedule();
+
+    private:
+
+        // executor that runs this task
+        Executor* executor_;
+    };
+
+    //-------------
+    /// How the value of a Future<T> is stored, set and returned. (specialized for void, which is stored as an
+    /// empty struct, so Future<void> and Promise<void> share the code of the other types)
+    template<typename T>
+    struct FutureValue {
+        typedef T type;
+
+        // type returned by SharedFuture::get()
+        typedef const T& const_reference;
+
+        // return fn(), to be stored.
+        template<typename Fn>
+        static type Call(Fn& fn);
+
+        // return fn(stored value), moving the value.
+        template<typename Fn>
+        static auto Invoke(Fn& fn, type& value) -> decltype(fn(c11::move(value)));
+
+        // move the stored value out.
+        static T Take(type& value);
+
+        // return the stored value, without moving it.
+        static const_reference Get(const type& value);
+    };
+
+    //-------------
+    template<>
+    struct FutureValue<void> {
+        struct type {};
+
+        typedef void const_reference;
+
+        template<typename Fn>
+        static type Call(Fn& fn);
+
+        template<typename Fn>
+        static auto Invoke(Fn& fn, type& value) -> decltype(fn());
+
+        static void Take(type& value);
+
+        static void Get(const type& value);
+    };
+
+    //-------------
+    /// State shared by a Promise and its Future. All synchronization is done on one atomic word:
+    /// checking a value that is already set is one load, and setting a value is two atomic operations, plus
+    /// a futex wake-up only if a thread is blocked waiting for it.
+    /// The value is constructed in place when it is set, so T doesn't need a default constructor.
+    /// Instead of a value, the same storage can hold an exception_ptr or an error_code. A reset Promise
+    /// stores future_errc::broken_promise, so failing doesn't construct a T or allocate memory.
     template<typename T>
     struct FutureState {
-        c11::mutex mutex;
-        c11::condition_variable cv;
-        bool notified;
-        bool promise_error;
-        T value;
+        /// Type of the stored value.
+        typedef typename FutureValue<T>::type value_type;
+
+        // bits of state
+        static const c11::uint32_t READY = 1;         // value (or an error) has been set
+        static const c11::uint32_t SETTING = 2;       // a Promise is setting value
+        static const c11::uint32_t WAITING = 4;       // a thread may be blocked on state
+        static const c11::uint32_t ERROR_CODE = 8;    // storage holds an error_code instead of value
+        static const c11::uint32_t CONTINUATION = 16; // continuation must be scheduled when value is set
+        static const c11::uint32_t EXCEPTION = 32;    // storage holds an exception_ptr instead of value
+
+        Futex::Word state;
+        typename c11::aligned_union<0, value_type, c11::exception_ptr, c11::error_code>::type storage;
+        FutureContinuation* continuation;
         FutureState();
         ~FutureState();
+
+        // return true if value has been set.
+        bool IsReady() const;
+
+        // block until value has been set. Spins for a while before blocking. (see SpinWait)
+        void Wait();
+
+        // block until value has been set or abs_time is reached. Returns false on timeout.
+        // Spins for a while before blocking, unless abs_time has already been reached.
+        template<typename Clock, typename Duration>
+        bool WaitUntil(const c11::chrono::time_point<Clock, Duration>& abs_time);
+
+        // claim the right to set value. Returns false if value was already set, or is being set.
+        bool TryClaim();
+
+        // release a claim without setting value. (if setting value threw an exception)
+        void CancelClaim();
+
+        // mark value as set (with error_bits, if storage holds an error), wake the threads waiting for it, and
+        // schedule the continuation. Must be preceded by a successful TryClaim().
+        void Publish(c11::uint32_t error_bits = 0);
+
+        // construct value from args and publish it. Returns false if value was already set, or is being set.
+        // If the constructor throws, the claim is released and the exception is passed on.
+        template<typename... Args>
+        bool TryEmplace(Args&&... args);
+
+        // same as TryEmplace(), but throws if value was already set.
+        template<typename... Args>
+        void Emplace(Args&&... args);
+
+        // return true if value has been set and constructed.
+        bool HasValue() const;
+
+        // return the value. Only valid if HasValue() is true.
+        value_type& GetValue();
+        const value_type& GetValue() const;
+
+        // store error instead of value, and publish it. Return false if value was already set, or is being set.
+        bool TrySetException(const c11::exception_ptr& error);
+        bool TrySetError(const c11::error_code& error);
+
+        // store the error of source, which must have one. Return false if value was already set, or is being set.
+        template<typename U>
+        bool TryCopyError(FutureState<U>& source);
+
+        // return true if state holds an exception_ptr or an error_code instead of value.
+        bool HasError() const;
+
+        // return the error_code stored instead of value, or an empty error_code if there isn't one.
+        c11::error_code GetErrorCode() const;
+
+        // return the exception_ptr stored instead of value, or an empty exception_ptr if there isn't one.
+        c11::exception_ptr GetException() const;
+
+        // throw the stored exception, or a c11::system_error for the stored error_code.
+        void ThrowError() const;
+
+        // attach a continuation, which is scheduled when value is set, or now if it is already set.
+        // Only called by the thread that owns the Future (which then() and WhenAll() consume).
+        // Throws if a continuation is already attached. new_continuation then still belongs to the caller.
+        void SetContinuation(FutureContinuation* new_continuation);
+
+        // if value isn't set, store future_errc::broken_promise instead. (the Promise was reset)
+        void Abandon();
         //--
         static const size_t element_size_;
 #include "pooled_new.inc"
     };
 
+    //-------------
+    /// Type of the value returned by calling Fn with a T (or with no argument if T is void). (see Future::then())
+    template<typename T, typename Fn>
+    struct FutureThenResult {
+        typedef typename c11::decay<decltype(FutureValue<T>::Invoke(c11::declval<Fn&>(),
+            c11::declval<typename FutureValue<T>::type&>()))>::type type;
+    };
+
+    template<typename T>
+    class SharedFuture;
+
     //-------------
     /// A class that can block execution until it receives a shared value set by a Promise object.
     template<typename T>
     class Future : public Linkable {
     public:
+
+        /// Type of the value.
+        typedef T value_type;
+
+        //---
+
         // Default constructor (no shared state).
         Future();
 
         // move constructor
-        Future(Future&);
+        Future(Future&& other) noexcept;
 
         // Destructor
         ~Future();
 
         // Move assignment operator
-        Future& operator=(Future&);
+        Future& operator=(Future&& other) noexcept;
 
         // swap object states
-        void swap(Future& other);
+        void swap(Future& other) noexcept;
 
         // reset object to a default constructed state
         void reset();
@@ -65,11 +229,19 @@ namespace ldl {
         // Return true if this object has a shared state.
         bool valid() const;
 
-        // call wait() and then return the value set by the Promise that shares state with object.
-        // If the Promise object is destroyed before setting value, behavior is undefined.
-        // Calling when this object is invalid results in undefined behavior.
+        // call wait() and then move out the value set by the Promise that shares state with object.
+        // If the Promise stored an exception, it is rethrown. If it stored an error_code, or was destroyed
+        // before setting value (future_errc::broken_promise), a c11::system_error is thrown.
+        // Throws if this object is invalid. This object is left invalid.
         T get();
 
+        // return true if the Promise stored an exception or an error_code instead of a value. Doesn't block.
+        bool has_error() const;
+
+        // return the error_code stored by the Promise (future_errc::broken_promise if it was destroyed before
+        // setting value), or an empty error_code. Doesn't block or throw, so errors can be checked cheaply.
+        c11::error_code get_error_code() const;
+
         // Wait until the promise object that shares state with this object sets value
         // and notifies the shared condition variable.
         // Calling when this object is invalid results in undefined behavior.
@@ -89,15 +261,44 @@ namespace ldl {
         template< typename Rep, typename Period>
         FutureStatus::type wait_for(const c11::chrono::duration<Rep, Period>& rel_time);
 
+        // return a Future for the result of fn(value) (or fn() for Future<void>), which is called on executor
+        // when the value is set, with the value moved out of the shared state,
+        // instead of blocking a thread until then. The continuation is allocated from a Pool.
+        // If this Future gets an error instead of a value, fn isn't called and the returned Future gets the error.
+        // If fn throws, the returned Future gets the exception. This object is left invalid.
+        template<typename Fn>
+        Future<typename FutureThenResult<T, Fn>::type> then(Executor& executor, Fn fn);
+
+        // same as then(InlineExecutor::Instance(), fn): fn runs on the thread that sets the value,
+        // or on this thread if the value is already set.
+        template<typename Fn>
+        Future<typename FutureThenResult<T, Fn>::type> then(Fn fn);
+
+        // return a SharedFuture with the shared state of this object, so the value can be read by several
+        // consumers. This object is left invalid.
+        SharedFuture<T> share();
+
     private:
 
-        // only Promise objects can construct valid Future objects.
+        // only Promise objects (and then()) can construct valid Future objects.
         template<typename U>
         friend class Promise;
 
+        template<typename U>
+        friend class Future;
+
+        // WhenAll() and WhenAny()
+        friend struct FutureJoin;
+
+        template<typename U>
+        friend class SharedFuture;
+
         // Construct a Future with the specified shared state
         Future(SharedPointer<FutureState<T>>& state_ptr);
 
+        Future(const Future&) = delete;
+        Future& operator=(const Future&) = delete;
+
         //---
 
         // shared pointer to FutureState shared with promise that created this
@@ -111,6 +312,117 @@ namespace ldl {
 
     }; //Future<T>
 
+    //-------------
+    /// Copyable Future, for a value that is read by several consumers. (see Future::share())
+    /// The value is stored once, in the state shared by all copies, and get() returns a reference to it.
+    /// Setting the value wakes every thread blocked on any of the copies with one futex wake-up.
+    /// Each thread should use its own copy, like c11::shared_future.
+    template<typename T>
+    class SharedFuture {
+    public:
+
+        /// Type of the value.
+        typedef T value_type;
+
+        //---
+
+        // Default constructor (no shared state).
+        SharedFuture();
+
+        // copy constructor
+        SharedFuture(const SharedFuture& other);
+
+        // move constructor
+        SharedFuture(SharedFuture&& other) noexcept;
+
+        // construct from a Future, which is left invalid.
+        SharedFuture(Future<T>&& other);
+
+        // Destructor
+        ~SharedFuture();
+
+        // Copy assignment operator
+        SharedFuture& operator=(const SharedFuture& other);
+
+        // Move assignment operator
+        SharedFuture& operator=(SharedFuture&& other) noexcept;
+
+        // swap object states
+        void swap(SharedFuture& other) noexcept;
+
+        // reset object to a default constructed state
+        void reset();
+
+        // Return true if this object has a shared state.
+        bool valid() const;
+
+        // call wait() and then return a reference to the value set by the Promise. The value stays in the shared
+        // state, so get() can be called again, and by other copies.
+        // Throws like Future::get() if the Promise stored an error instead, or if this object is invalid.
+        typename FutureValue<T>::const_reference get() const;
+
+        // return true if the Promise stored an exception or an error_code instead of a value. Doesn't block.
+        bool has_error() const;
+
+        // same as Future::get_error_code()
+        c11::error_code get_error_code() const;
+
+        // block until the Promise sets the value (or an error).
+        // Throws if this object is invalid.
+        void wait() const;
+
+        // same as wait(), but returns timeout if abs_time is reached first.
+        template<typename Clock, typename Duration>
+        FutureStatus::type wait_until(const c11::chrono::time_point<Clock, Duration>& abs_time) const;
+
+        // same as wait(), but returns timeout if rel_time elapses first.
+        template<typename Rep, typename Period>
+        FutureStatus::type wait_for(const c11::chrono::duration<Rep, Period>& rel_time) const;
+
+    private:
+
+        // shared pointer to FutureState shared with the Promise
+        SharedPointer<FutureState<T>> state_ptr_;
+
+        //---
+
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+
+    }; //SharedFuture<T>
+
+    //-------------
+    /// Continuation created by Future::then(): sets the value of result to fn(source value).
+    template<typename T, typename U, typename Fn>
+    class ThenContinuation : public FutureContinuation {
+    public:
+
+        // constructor
+        ThenContinuation(Executor& executor, const SharedPointer<FutureState<T>>& source,
+            const SharedPointer<FutureState<U>>& result, const Fn& fn);
+
+        // set the value of result_, and delete this.
+        virtual void Run();
+
+    private:
+
+        // state whose value is passed to fn_
+        SharedPointer<FutureState<T>> source_;
+
+        // state of the Future returned by then()
+        SharedPointer<FutureState<U>> result_;
+
+        // function to call
+        Fn fn_;
+
+        //---
+
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+    };
+
     //-------------
     template<typename T>
     class Promise : public Linkable {
@@ -120,17 +432,16 @@ namespace ldl {
         Promise();
 
         // move constructor
-        Promise(Promise&);
+        Promise(Promise&& other) noexcept;
 
         // destroy a promise object
         ~Promise();
 
         // move assignment
-        Promise& operator=(Promise&);
+        Promise& operator=(Promise&& other) noexcept;
 
         // swap states of two objects.
-        // allows us to move-assign and move-construct Future objects with a pre-C11 compiler.
-        void swap(Promise& other);
+        void swap(Promise& other) noexcept;
 
         // reset object to a default constructed state
         void reset();
@@ -138,8 +449,25 @@ namespace ldl {
         // construct a Future object with the same shared state as this object.
         Future<T> get_future();
 
-        // set the value of the shared state and notify the shared condition variable.
-        void set_value(const T& value);
+        // set the value of the shared state and wake the Future. Throws if the value was already set.
+        void set_value(const typename FutureValue<T>::type& value);
+
+        // same as set_value(value), but moves value into the shared state.
+        void set_value(typename FutureValue<T>::type&& value);
+
+        // set the value of a Promise<void>.
+        void set_value();
+
+        // construct the value in the shared state from args, without copying or moving it.
+        template<typename... Args>
+        void emplace_value(Args&&... args);
+
+        // store an exception instead of a value. Future::get() rethrows it.
+        void set_exception(c11::exception_ptr error);
+
+        // store an error_code instead of a value. Unlike set_exception(), this doesn't allocate memory.
+        // Future::get() throws a c11::system_error, and Future::get_error_code() returns error.
+        void set_error(const c11::error_code& error);
 
     private:
 
@@ -147,6 +475,9 @@ namespace ldl {
 
         SharedPointer<FutureState<T>> state_ptr_;
 
+        Promise(const Promise&) = delete;
+        Promise& operator=(const Promise&) = delete;
+
         //---
 
         static const size_t element_size_;
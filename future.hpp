@@ -2,15 +2,87 @@
 
 #include <exception>
 #include <algorithm> //swap
-#include <mutex> //unique_lock
+#include <new> // placement new
+#include <utility> // move, forward
 
 namespace ldl {
 
+    //---------------
+    template<typename T>
+    template<typename Fn>
+    typename FutureValue<T>::type FutureValue<T>::Call(Fn& fn)
+    {
+        return fn();
+    }
+
+    //---------------
+    template<typename T>
+    template<typename Fn>
+    auto FutureValue<T>::Invoke(Fn& fn, type& value) -> decltype(fn(c11::move(value)))
+    {
+        return fn(c11::move(value));
+    }
+
+    //---------------
+    template<typename T>
+    T FutureValue<T>::Take(type& value)
+    {
+        return c11::move(value);
+    }
+
+    //---------------
+    template<typename T>
+    typename FutureValue<T>::const_reference FutureValue<T>::Get(const type& value)
+    {
+        return value;
+    }
+
+    //---------------
+    template<typename Fn>
+    FutureValue<void>::type FutureValue<void>::Call(Fn& fn)
+    {
+        fn();
+        return type();
+    }
+
+    //---------------
+    template<typename Fn>
+    auto FutureValue<void>::Invoke(Fn& fn, type&) -> decltype(fn())
+    {
+        return fn();
+    }
+
+    //---------------
+    inline void FutureValue<void>::Take(type&)
+    {
+    }
+
+    //---------------
+    inline void FutureValue<void>::Get(const type&)
+    {
+    }
+
+    //==========================
+
+    //---------------
+    inline FutureContinuation::FutureContinuation(Executor& executor)
+        : executor_(&executor)
+    {
+    }
+
+    //---------------
+    inline void FutureContinuation::Schedule()
+    {
+        executor_->Execute(this);
+    }
+
+    //==========================
+
     //---------------
     template<typename T>
     FutureState<T>::FutureState()
-        : notified(false)
-        , promise_error(false)
+        : state(0)
+        , continuation(0)
     {
     }
 
@@ -18,8 +90,248 @@ namespace ldl {
     template<typename T>
     FutureState<T>::~FutureState()
     {
-        notified = false;
-        //NOTHING
+        if (HasValue()) {
+            GetValue().~value_type();
+        }
+        else if (state.load(c11::memory_order_relaxed) & EXCEPTION) {
+            reinterpret_cast<c11::exception_ptr*>(&storage)->~exception_ptr();
+        }
+    }
+
+    //---------------
+    template<typename T>
+    bool FutureState<T>::IsReady() const
+    {
+        // acquire, so the value written before Publish() is visible
+        return ((state.load(c11::memory_order_acquire) & READY) != 0);
+    }
+
+    //---------------
+    template<typename T>
+    void FutureState<T>::Wait()
+    {
+        if (IsReady() || SpinWait::SpinUntil([this] { return IsReady(); })) {
+            return;
+        }
+        c11::uint32_t current = state.load(c11::memory_order_acquire);
+        while (!(current & READY)) {
+            // tell Publish() that it must wake someone, then sleep unless state has changed.
+            if (!(current & WAITING)) {
+                if (!state.compare_exchange_weak(current, current | WAITING, c11::memory_order_acquire)) {
+                    continue;
+                }
+                current |= WAITING;
+            }
+            Futex::Wait(state, current);
+            current = state.load(c11::memory_order_acquire);
+        }
+    }
+
+    //---------------
+    template<typename T>
+    template<typename Clock, typename Duration>
+    bool FutureState<T>::WaitUntil(const c11::chrono::time_point<Clock, Duration>& abs_time)
+    {
+        if (IsReady()) {
+            return true;
+        }
+        if (Clock::now() < abs_time && SpinWait::SpinUntil([this] { return IsReady(); })) {
+            return true;
+        }
+        c11::uint32_t current = state.load(c11::memory_order_acquire);
+        while (!(current & READY)) {
+            if (!(current & WAITING)) {
+                if (!state.compare_exchange_weak(current, current | WAITING, c11::memory_order_acquire)) {
+                    continue;
+                }
+                current |= WAITING;
+            }
+            if (!Futex::WaitUntil(state, current, abs_time)) {
+                return IsReady(); // timed out
+            }
+            current = state.load(c11::memory_order_acquire);
+        }
+        return true;
+    }
+
+    //---------------
+    template<typename T>
+    bool FutureState<T>::TryClaim()
+    {
+        c11::uint32_t current = state.load(c11::memory_order_relaxed);
+        while (!(current & (READY | SETTING))) {
+            if (state.compare_exchange_weak(current, current | SETTING, c11::memory_order_acquire, c11::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //---------------
+    template<typename T>
+    void FutureState<T>::CancelClaim()
+    {
+        state.fetch_and(~SETTING, c11::memory_order_relaxed);
+    }
+
+    //---------------
+    template<typename T>
+    void FutureState<T>::Publish(c11::uint32_t error_bits)
+    {
+        // clear SETTING and set READY and error_bits, keeping the other bits. release, so waiters see value.
+        c11::uint32_t previous = state.fetch_xor(SETTING | READY | error_bits, c11::memory_order_acq_rel);
+        if (previous & WAITING) {
+            Futex::WakeAll(state);
+        }
+        if (previous & CONTINUATION) {
+            continuation->Schedule();
+        }
+    }
+
+    //---------------
+    template<typename T>
+    template<typename... Args>
+    bool FutureState<T>::TryEmplace(Args&&... args)
+    {
+        if (!TryClaim()) {
+            return false;
+        }
+        try {
+            new(static_cast<void*>(&storage)) value_type(c11::forward<Args>(args)...);
+        }
+        catch (...) {
+            CancelClaim();
+            throw;
+        }
+        Publish();
+        return true;
+    }
+
+    //---------------
+    template<typename T>
+    template<typename... Args>
+    void FutureState<T>::Emplace(Args&&... args)
+    {
+        if (!TryEmplace(c11::forward<Args>(args)...)) {
+            throw std::runtime_error("value already set");
+        }
+    }
+
+    //---------------
+    template<typename T>
+    bool FutureState<T>::HasValue() const
+    {
+        return ((state.load(c11::memory_order_acquire) & (READY | ERROR_CODE | EXCEPTION)) == READY);
+    }
+
+    //---------------
+    template<typename T>
+    typename FutureState<T>::value_type& FutureState<T>::GetValue()
+    {
+        return *reinterpret_cast<value_type*>(&storage);
+    }
+
+    //---------------
+    template<typename T>
+    const typename FutureState<T>::value_type& FutureState<T>::GetValue() const
+    {
+        return *reinterpret_cast<const value_type*>(&storage);
+    }
+
+    //---------------
+    template<typename T>
+    bool FutureState<T>::TrySetException(const c11::exception_ptr& error)
+    {
+        if (!TryClaim()) {
+            return false;
+        }
+        new(static_cast<void*>(&storage)) c11::exception_ptr(error); // doesn't throw
+        Publish(EXCEPTION);
+        return true;
+    }
+
+    //---------------
+    template<typename T>
+    bool FutureState<T>::TrySetError(const c11::error_code& error)
+    {
+        if (!TryClaim()) {
+            return false;
+        }
+        new(static_cast<void*>(&storage)) c11::error_code(error);
+        Publish(ERROR_CODE);
+        return true;
+    }
+
+    //---------------
+    template<typename T>
+    template<typename U>
+    bool FutureState<T>::TryCopyError(FutureState<U>& source)
+    {
+        c11::exception_ptr exception = source.GetException();
+        return exception ? TrySetException(exception) : TrySetError(source.GetErrorCode());
+    }
+
+    //---------------
+    template<typename T>
+    bool FutureState<T>::HasError() const
+    {
+        return ((state.load(c11::memory_order_acquire) & (ERROR_CODE | EXCEPTION)) != 0);
+    }
+
+    //---------------
+    template<typename T>
+    c11::error_code FutureState<T>::GetErrorCode() const
+    {
+        if (state.load(c11::memory_order_acquire) & ERROR_CODE) {
+            return *reinterpret_cast<const c11::error_code*>(&storage);
+        }
+        return c11::error_code();
+    }
+
+    //---------------
+    template<typename T>
+    c11::exception_ptr FutureState<T>::GetException() const
+    {
+        if (state.load(c11::memory_order_acquire) & EXCEPTION) {
+            return *reinterpret_cast<const c11::exception_ptr*>(&storage);
+        }
+        return c11::exception_ptr();
+    }
+
+    //---------------
+    template<typename T>
+    void FutureState<T>::ThrowError() const
+    {
+        c11::exception_ptr exception = GetException();
+        if (exception) {
+            c11::rethrow_exception(exception);
+        }
+        throw c11::system_error(GetErrorCode());
+    }
+
+    //---------------
+    template<typename T>
+    void FutureState<T>::SetContinuation(FutureContinuation* new_continuation)
+    {
+        c11::uint32_t current = state.load(c11::memory_order_acquire);
+        while (!(current & READY)) {
+            if (current & CONTINUATION) {
+                // Publish() may be reading the attached continuation, so don't touch it
+                throw std::runtime_error("continuation already set");
+            }
+            continuation = new_continuation; // published by the release below
+            if (state.compare_exchange_weak(current, current | CONTINUATION, c11::memory_order_acq_rel, c11::memory_order_acquire)) {
+                return; // Publish() will schedule it
+            }
+        }
+        new_continuation->Schedule();
+    }
+
+    //---------------
+    template<typename T>
+    void FutureState<T>::Abandon()
+    {
+        TrySetError(c11::make_error_code(c11::future_errc::broken_promise));
     }
 
     //---------------
@@ -35,10 +347,9 @@ namespace ldl {
 
     //---------------
     template<typename T>
-    Future<T>::Future(Future& other)
-        : state_ptr_(0)
+    Future<T>::Future(Future&& other) noexcept
+        : state_ptr_(c11::move(other.state_ptr_))
     {
-        swap(other); // move
     }
 
     //---------------
@@ -50,18 +361,15 @@ namespace ldl {
 
     //---------------
     template<typename T>
-    Future<T>& Future<T>::operator=(Future& other)
+    Future<T>& Future<T>::operator=(Future&& other) noexcept
     {
-        if (this != &other) {
-            reset();
-            swap(other); // move
-        }
+        state_ptr_ = c11::move(other.state_ptr_);
         return *this;
     }
 
     //---------------
     template<typename T>
-    void Future<T>::swap(Future& other) {
+    void Future<T>::swap(Future& other) noexcept {
         if (this != &other) {
             state_ptr_.swap(other.state_ptr_); // swap SharedPointer
         }
@@ -88,10 +396,26 @@ namespace ldl {
             throw std::runtime_error("Future is not valid");
         }
         wait(); // block until promise notifies future
-        if (state_ptr_->promise_error) { // if woken because Promise was destroyed
-            throw std::runtime_error("promise was destroyed before setting value,");
+        SharedPointer<FutureState<T>> state_ptr;
+        state_ptr.swap(state_ptr_); // this object is consumed
+        if (state_ptr->HasError()) { // exception, error code, or Promise was destroyed
+            state_ptr->ThrowError();
         }
-        return state_ptr_->value;
+        return FutureValue<T>::Take(state_ptr->GetValue());
+    }
+
+    //---------------
+    template<typename T>
+    bool Future<T>::has_error() const
+    {
+        return state_ptr_ && state_ptr_->HasError();
+    }
+
+    //---------------
+    template<typename T>
+    c11::error_code Future<T>::get_error_code() const
+    {
+        return state_ptr_ ? state_ptr_->GetErrorCode() : c11::error_code();
     }
 
     //---------------
@@ -101,10 +425,7 @@ namespace ldl {
         if (!state_ptr_) {
             throw std::runtime_error("future is not valid");
         }
-        c11::unique_lock<c11::mutex> lock(state_ptr_->mutex);
-        while (!state_ptr_->notified) { //ignore spurious wake-ups
-            state_ptr_->cv.wait(lock);
-        }
+        state_ptr_->Wait();
     }
 
     //---------------
@@ -112,18 +433,10 @@ namespace ldl {
     template<typename Clock, typename Duration>
     FutureStatus::type Future<T>::wait_until(const c11::chrono::time_point<Clock, Duration >& abs_time)
     {
-        FutureStatus::type retval = FutureStatus::ready;
         if (!state_ptr_) {
             throw std::runtime_error("future is not valid");
         }
-        c11::unique_lock<c11::mutex> lock(state_ptr_->mutex);
-        while (!state_ptr_->notified) { //ignore spurious wake-ups
-            if (state_ptr_->cv.wait_until(lock, abs_time) == c11::cv_status::timeout) {
-                retval = FutureStatus::timeout;
-                break; //stop waiting
-            }
-        }
-        return retval;
+        return state_ptr_->WaitUntil(abs_time) ? FutureStatus::ready : FutureStatus::timeout;
     }
 
     //---------------
@@ -134,6 +447,44 @@ namespace ldl {
         return wait_until(c11::chrono::steady_clock::now() + rel_time);
     }
 
+    //---------------
+    template<typename T>
+    template<typename Fn>
+    Future<typename FutureThenResult<T, Fn>::type> Future<T>::then(Executor& executor, Fn fn)
+    {
+        typedef typename FutureThenResult<T, Fn>::type U;
+        if (!state_ptr_) {
+            throw std::runtime_error("future is not valid");
+        }
+        SharedPointer<FutureState<U>> result_ptr(new FutureState<U>());
+        SharedPointer<FutureState<T>> state_ptr;
+        state_ptr.swap(state_ptr_); // this object is consumed
+        ThenContinuation<T, U, Fn>* continuation = new ThenContinuation<T, U, Fn>(executor, state_ptr, result_ptr, fn);
+        try {
+            state_ptr->SetContinuation(continuation);
+        }
+        catch (...) {
+            delete continuation;
+            throw;
+        }
+        return Future<U>(result_ptr);
+    }
+
+    //---------------
+    template<typename T>
+    template<typename Fn>
+    Future<typename FutureThenResult<T, Fn>::type> Future<T>::then(Fn fn)
+    {
+        return then(InlineExecutor::Instance(), fn);
+    }
+
+    //---------------
+    template<typename T>
+    SharedFuture<T> Future<T>::share()
+    {
+        return SharedFuture<T>(c11::move(*this));
+    }
+
     //---------------
     template<typename T>
     Future<T>::Future(SharedPointer<FutureState<T>>& state_ptr)
@@ -147,6 +498,176 @@ namespace ldl {
 
     //==========================
 
+    //---------------
+    template<typename T>
+    SharedFuture<T>::SharedFuture()
+        : state_ptr_(0)
+    {
+    }
+
+    //---------------
+    template<typename T>
+    SharedFuture<T>::SharedFuture(const SharedFuture& other)
+        : state_ptr_(other.state_ptr_)
+    {
+    }
+
+    //---------------
+    template<typename T>
+    SharedFuture<T>::SharedFuture(SharedFuture&& other) noexcept
+        : state_ptr_(c11::move(other.state_ptr_))
+    {
+    }
+
+    //---------------
+    template<typename T>
+    SharedFuture<T>::SharedFuture(Future<T>&& other)
+        : state_ptr_(0)
+    {
+        state_ptr_.swap(other.state_ptr_);
+    }
+
+    //---------------
+    template<typename T>
+    SharedFuture<T>::~SharedFuture()
+    {
+        reset();
+    }
+
+    //---------------
+    template<typename T>
+    SharedFuture<T>& SharedFuture<T>::operator=(const SharedFuture& other)
+    {
+        state_ptr_ = other.state_ptr_;
+        return *this;
+    }
+
+    //---------------
+    template<typename T>
+    SharedFuture<T>& SharedFuture<T>::operator=(SharedFuture&& other) noexcept
+    {
+        state_ptr_ = c11::move(other.state_ptr_);
+        return *this;
+    }
+
+    //---------------
+    template<typename T>
+    void SharedFuture<T>::swap(SharedFuture& other) noexcept
+    {
+        state_ptr_.swap(other.state_ptr_);
+    }
+
+    //---------------
+    template<typename T>
+    void SharedFuture<T>::reset()
+    {
+        state_ptr_.reset();
+    }
+
+    //---------------
+    template<typename T>
+    bool SharedFuture<T>::valid() const
+    {
+        return (bool)state_ptr_;
+    }
+
+    //---------------
+    template<typename T>
+    typename FutureValue<T>::const_reference SharedFuture<T>::get() const
+    {
+        wait();
+        if (state_ptr_->HasError()) {
+            state_ptr_->ThrowError();
+        }
+        return FutureValue<T>::Get(state_ptr_->GetValue());
+    }
+
+    //---------------
+    template<typename T>
+    bool SharedFuture<T>::has_error() const
+    {
+        return state_ptr_ && state_ptr_->HasError();
+    }
+
+    //---------------
+    template<typename T>
+    c11::error_code SharedFuture<T>::get_error_code() const
+    {
+        return state_ptr_ ? state_ptr_->GetErrorCode() : c11::error_code();
+    }
+
+    //---------------
+    template<typename T>
+    void SharedFuture<T>::wait() const
+    {
+        if (!state_ptr_) {
+            throw std::runtime_error("future is not valid");
+        }
+        state_ptr_->Wait();
+    }
+
+    //---------------
+    template<typename T>
+    template<typename Clock, typename Duration>
+    FutureStatus::type SharedFuture<T>::wait_until(const c11::chrono::time_point<Clock, Duration>& abs_time) const
+    {
+        if (!state_ptr_) {
+            throw std::runtime_error("future is not valid");
+        }
+        return state_ptr_->WaitUntil(abs_time) ? FutureStatus::ready : FutureStatus::timeout;
+    }
+
+    //---------------
+    template<typename T>
+    template<typename Rep, typename Period>
+    FutureStatus::type SharedFuture<T>::wait_for(const c11::chrono::duration<Rep, Period>& rel_time) const
+    {
+        return wait_until(c11::chrono::steady_clock::now() + rel_time);
+    }
+
+    //---------------
+    template<typename T>
+    const size_t SharedFuture<T>::element_size_ = sizeof(SharedFuture<T>);
+
+    //==========================
+
+    //---------------
+    template<typename T, typename U, typename Fn>
+    ThenContinuation<T, U, Fn>::ThenContinuation(Executor& executor, const SharedPointer<FutureState<T>>& source,
+        const SharedPointer<FutureState<U>>& result, const Fn& fn)
+        : FutureContinuation(executor)
+        , source_(source)
+        , result_(result)
+        , fn_(fn)
+    {
+    }
+
+    //---------------
+    template<typename T, typename U, typename Fn>
+    void ThenContinuation<T, U, Fn>::Run()
+    {
+        if (source_->HasError()) {
+            result_->TryCopyError(*source_);
+        }
+        else {
+            try {
+                // the Future of source_ was consumed by then(), so its value can be moved into fn_
+                auto call = [this]() { return FutureValue<T>::Invoke(fn_, source_->GetValue()); };
+                result_->Emplace(FutureValue<U>::Call(call));
+            }
+            catch (...) {
+                result_->TrySetException(c11::current_exception());
+            }
+        }
+        delete this;
+    }
+
+    //---------------
+    template<typename T, typename U, typename Fn>
+    const size_t ThenContinuation<T, U, Fn>::element_size_ = sizeof(ThenContinuation<T, U, Fn>);
+
+    //==========================
+
     //---------------
     template<typename T>
     Promise<T>::Promise()
@@ -156,11 +677,11 @@ namespace ldl {
     }
     //---------------
     template<typename T>
-    Promise<T>::Promise(Promise& other)
-        : future_constructed_(false)
-        , state_ptr_(0)
+    Promise<T>::Promise(Promise&& other) noexcept
+        : future_constructed_(other.future_constructed_)
+        , state_ptr_(c11::move(other.state_ptr_))
     {
-        swap(other); // move
+        other.future_constructed_ = false;
     }
 
     //---------------
@@ -172,18 +693,18 @@ namespace ldl {
 
     //---------------
     template<typename T>
-    Promise<T>& Promise<T>::operator=(Promise& other)
+    Promise<T>& Promise<T>::operator=(Promise&& other) noexcept
     {
         if (this != &other) {
-            reset();
-            swap(other); // move
+            reset(); // abandon current state
+            swap(other);
         }
         return *this;
     }
 
     //---------------
     template<typename T>
-    void Promise<T>::swap(Promise& other)
+    void Promise<T>::swap(Promise& other) noexcept
     {
         if (this != &other) {
             state_ptr_.swap(other.state_ptr_);
@@ -196,12 +717,7 @@ namespace ldl {
     void Promise<T>::reset()
     {
         if (state_ptr_) {
-            c11::lock_guard<c11::mutex> lock(state_ptr_->mutex);
-            state_ptr_->promise_error = true;
-        } // unlock before calling set_value
-        // if necessary, wake promise
-        if (future_constructed_ && state_ptr_ && !state_ptr_->notified) {
-            set_value(T());
+            state_ptr_->Abandon(); // if necessary, wake future
         }
         state_ptr_.reset();
         future_constructed_ = false;
@@ -217,22 +733,59 @@ namespace ldl {
         if (!state_ptr_) {
             state_ptr_.reset(new FutureState<T>());
         }
+        future_constructed_ = true;
         return Future<T>(state_ptr_); // copy SharedPointer to future
     }
 
     //---------------
     template<typename T>
-    void Promise<T>::set_value(const T& value) {
+    void Promise<T>::set_value(const typename FutureValue<T>::type& value) {
+        emplace_value(value);
+    }
+
+    //---------------
+    template<typename T>
+    void Promise<T>::set_value(typename FutureValue<T>::type&& value) {
+        emplace_value(c11::move(value));
+    }
+
+    //---------------
+    template<typename T>
+    void Promise<T>::set_value() {
+        static_assert(c11::is_void<T>::value, "set_value() without a value is only for Promise<void>");
+        emplace_value();
+    }
+
+    //---------------
+    template<typename T>
+    template<typename... Args>
+    void Promise<T>::emplace_value(Args&&... args) {
+        if (!state_ptr_) {
+            state_ptr_.reset(new FutureState<T>());
+        }
+        state_ptr_->Emplace(c11::forward<Args>(args)...);
+    }
+
+    //---------------
+    template<typename T>
+    void Promise<T>::set_exception(c11::exception_ptr error) {
+        if (!state_ptr_) {
+            state_ptr_.reset(new FutureState<T>());
+        }
+        if (!state_ptr_->TrySetException(error)) {
+            throw std::runtime_error("value already set");
+        }
+    }
+
+    //---------------
+    template<typename T>
+    void Promise<T>::set_error(const c11::error_code& error) {
         if (!state_ptr_) {
             state_ptr_.reset(new FutureState<T>());
         }
-        c11::lock_guard<c11::mutex> lock(state_ptr_->mutex);
-        if (state_ptr_->notified) {
+        if (!state_ptr_->TrySetError(error)) {
             throw std::runtime_error("value already set");
         }
-        state_ptr_->value = value;
-        state_ptr_->notified = true;
-        state_ptr_->cv.notify_one();
     }
 
     //---------------
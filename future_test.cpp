@@ -11,6 +11,10 @@ namespace c11 {
     using namespace std;
 }
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 //-------------------------------------------
@@ -54,7 +58,7 @@ BOOST_AUTO_TEST_CASE( future_test )
         ldl::Promise<int> prom;
 
         ldl::Future<int> fut;
-        fut.swap(prom.get_future());
+        fut = prom.get_future();
 
         c11::thread th2(c11::bind(promise_thread, &prom, 2));
 
@@ -66,11 +70,354 @@ BOOST_AUTO_TEST_CASE( future_test )
             th2.join();
         }
 
+        // move
+        BOOST_CHECK(std::is_nothrow_move_constructible<ldl::Future<int> >::value);
+        BOOST_CHECK(std::is_nothrow_move_constructible<ldl::Promise<int> >::value);
+        ldl::Promise<int> prom3;
+        ldl::Future<int> fut3(prom3.get_future());
+        ldl::Promise<int> prom4(std::move(prom3));
+        ldl::Future<int> fut4;
+        fut4 = std::move(fut3);
+        BOOST_CHECK_EQUAL(fut3.valid(), false);
+        BOOST_CHECK_EQUAL(fut4.valid(), true);
+        prom4.set_value(3);
+        BOOST_CHECK_EQUAL(fut4.get(), 3);
+
     }
     catch (const std::exception& ex) {
         BOOST_TEST_MESSAGE("exception in future-test: " << ex.what());
     }
 }
 
+BOOST_AUTO_TEST_CASE(future_state_test)
+{
+    BOOST_TEST_MESSAGE("Starting future_state_test");
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // no mutex or condition variable in the shared state (the value shares storage with an error)
+        BOOST_CHECK(sizeof(ldl::FutureState<int>) <= 4 * sizeof(void*));
+
+        // value already set: no waiting
+        ldl::Promise<int> prom;
+        ldl::Future<int> fut = prom.get_future();
+        BOOST_CHECK(fut.wait_for(c11::chrono::milliseconds(10)) == ldl::FutureStatus::timeout);
+        prom.set_value(5);
+        BOOST_CHECK(fut.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::ready);
+        BOOST_CHECK_EQUAL(fut.get(), 5);
+        BOOST_CHECK_THROW(prom.set_value(6), std::runtime_error);
+
+        // one value wins when several threads set it
+        for (size_t ix = 0; ix < 100; ++ix) {
+            ldl::Promise<int> prom2;
+            ldl::Future<int> fut2 = prom2.get_future();
+            c11::atomic<int> winners(0);
+            std::vector<c11::thread> threads;
+            for (int jx = 0; jx < 3; ++jx) {
+                threads.push_back(c11::thread([&prom2, &winners, jx]() {
+                    try {
+                        prom2.set_value(jx);
+                        ++winners;
+                    }
+                    catch (const std::runtime_error&) {
+                    }
+                }));
+            }
+            int val = fut2.get();
+            for (size_t jx = 0; jx < threads.size(); ++jx) {
+                threads[jx].join();
+            }
+            BOOST_CHECK_EQUAL(winners.load(), 1);
+            BOOST_CHECK(val >= 0 && val < 3);
+        }
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in future_state_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(future_then_test)
+{
+    BOOST_TEST_MESSAGE("Starting future_then_test");
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // chain of inline continuations runs when the value is set
+        ldl::Promise<int> prom;
+        ldl::Future<int> fut = prom.get_future();
+        ldl::Future<double> chained = fut.then([](int x) { return x * 2; }).then([](int x) { return x + 0.5; });
+        BOOST_CHECK_EQUAL(fut.valid(), false);
+        BOOST_CHECK(chained.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::timeout);
+        prom.set_value(20);
+        BOOST_CHECK_EQUAL(chained.get(), 40.5);
+
+        // value already set: runs immediately
+        ldl::Promise<int> prom2;
+        ldl::Future<int> fut2 = prom2.get_future();
+        prom2.set_value(3);
+        BOOST_CHECK_EQUAL(fut2.then([](int x) { return x * 3; }).get(), 9);
+
+        // runs on the executor's thread
+        struct ThreadExecutor : public ldl::Executor {
+            virtual void Execute(ldl::ExecutorTask* task) {
+                threads.push_back(c11::thread([task]() { task->Run(); }));
+            }
+            std::vector<c11::thread> threads;
+        } executor;
+        ldl::Promise<int> prom3;
+        ldl::Future<c11::thread::id> fut3 = prom3.get_future().then(executor, [](int) { return c11::this_thread::get_id(); });
+        prom3.set_value(1);
+        BOOST_CHECK(fut3.get() != c11::this_thread::get_id());
+        for (size_t ix = 0; ix < executor.threads.size(); ++ix) {
+            executor.threads[ix].join();
+        }
+
+        // an exception thrown by the continuation, or a Promise that is reset, reaches the end of the chain
+        ldl::Promise<int> prom4;
+        ldl::Future<int> fut4 = prom4.get_future().then([](int) -> int { throw std::runtime_error("failed"); });
+        prom4.set_value(1);
+        BOOST_CHECK_THROW(fut4.get(), std::runtime_error);
+
+        ldl::Future<int> fut5;
+        {
+            ldl::Promise<int> prom5;
+            fut5 = prom5.get_future().then([](int x) { return x; });
+        }
+        BOOST_CHECK_THROW(fut5.get(), std::runtime_error);
+
+        // a second continuation is refused without disturbing the first, and stays with the caller
+        struct CountContinuation : public ldl::FutureContinuation {
+            explicit CountContinuation(int* runs) : ldl::FutureContinuation(ldl::InlineExecutor::Instance()), runs(runs) {}
+            virtual void Run() { ++*runs; }
+            int* runs;
+        };
+        int first_runs = 0;
+        int second_runs = 0;
+        CountContinuation first(&first_runs);
+        CountContinuation second(&second_runs);
+        ldl::FutureState<int> state;
+        state.SetContinuation(&first);
+        BOOST_CHECK_THROW(state.SetContinuation(&second), std::runtime_error);
+        BOOST_CHECK(state.continuation == &first);
+        state.Emplace(1);
+        BOOST_CHECK_EQUAL(first_runs, 1);
+        BOOST_CHECK_EQUAL(second_runs, 0);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in future_then_test: " << ex.what());
+    }
+}
+
+namespace {
+
+    // counts copies, and has no default constructor
+    struct Payload {
+        Payload(int id, int* copies) : id(id), copies(copies) {}
+        Payload(const Payload& other) : id(other.id), copies(other.copies) { ++*copies; }
+        Payload(Payload&& other) : id(other.id), copies(other.copies) {}
+        Payload& operator=(const Payload& other) { id = other.id; copies = other.copies; ++*copies; return *this; }
+        Payload& operator=(Payload&& other) { id = other.id; copies = other.copies; return *this; }
+        int id;
+        int* copies;
+    };
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(future_move_test)
+{
+    BOOST_TEST_MESSAGE("Starting future_move_test");
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // value constructed in place and moved out: no copies, no default constructor
+        int copies = 0;
+        ldl::Promise<Payload> prom;
+        ldl::Future<Payload> fut = prom.get_future();
+        prom.emplace_value(7, &copies);
+        Payload payload = fut.get();
+        BOOST_CHECK_EQUAL(payload.id, 7);
+        BOOST_CHECK_EQUAL(copies, 0);
+        BOOST_CHECK_EQUAL(fut.valid(), false);
+        BOOST_CHECK_THROW(fut.get(), std::runtime_error);
+
+        // set_value(T&&), and a move-only type through then()
+        ldl::Promise<std::unique_ptr<int>> prom2;
+        ldl::Future<std::unique_ptr<int>> fut2 = prom2.get_future()
+            .then([](std::unique_ptr<int> ptr) { *ptr += 1; return ptr; });
+        prom2.set_value(std::unique_ptr<int>(new int(41)));
+        std::unique_ptr<int> ptr = fut2.get();
+        BOOST_CHECK_EQUAL(*ptr, 42);
+
+        ldl::Promise<Payload> prom3;
+        ldl::Future<int> fut3 = prom3.get_future().then([](Payload p) { return p.id; });
+        prom3.set_value(Payload(3, &copies));
+        BOOST_CHECK_EQUAL(fut3.get(), 3);
+        BOOST_CHECK_EQUAL(copies, 0);
+
+        // the value is destroyed with the shared state, and not constructed if the Promise is reset
+        std::shared_ptr<int> tracker(new int(0));
+        {
+            ldl::Promise<std::shared_ptr<int>> prom4;
+            ldl::Future<std::shared_ptr<int>> fut4 = prom4.get_future();
+            prom4.set_value(tracker);
+            BOOST_CHECK_EQUAL(tracker.use_count(), 2);
+        }
+        BOOST_CHECK_EQUAL(tracker.use_count(), 1);
+        ldl::Future<Payload> fut5;
+        {
+            ldl::Promise<Payload> prom5;
+            fut5 = prom5.get_future();
+        }
+        BOOST_CHECK_THROW(fut5.get(), std::runtime_error);
+
+        // Future<void>
+        ldl::Promise<void> prom6;
+        ldl::Future<void> fut6 = prom6.get_future();
+        BOOST_CHECK(fut6.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::timeout);
+        prom6.set_value();
+        fut6.get();
+        BOOST_CHECK_THROW(prom6.set_value(), std::runtime_error);
+
+        int calls = 0;
+        ldl::Promise<void> prom8;
+        ldl::Future<std::string> fut8 = prom8.get_future()
+            .then([&calls]() { ++calls; })
+            .then([&calls]() { ++calls; return std::string("done"); });
+        prom8.set_value();
+        BOOST_CHECK_EQUAL(fut8.get(), "done");
+        BOOST_CHECK_EQUAL(calls, 2);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in future_move_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(future_error_test)
+{
+    BOOST_TEST_MESSAGE("Starting future_error_test");
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // exception is rethrown by get()
+        ldl::Promise<int> prom;
+        ldl::Future<int> fut = prom.get_future();
+        BOOST_CHECK_EQUAL(fut.has_error(), false);
+        prom.set_exception(c11::make_exception_ptr(std::invalid_argument("bad")));
+        BOOST_CHECK_EQUAL(fut.has_error(), true);
+        BOOST_CHECK(!fut.get_error_code());
+        BOOST_CHECK_THROW(fut.get(), std::invalid_argument);
+        BOOST_CHECK_THROW(prom.set_value(1), std::runtime_error);
+
+        // error code: inspected without throwing, or thrown as a system_error. No T is constructed.
+        int copies = 0;
+        ldl::Promise<Payload> prom2;
+        ldl::Future<Payload> fut2 = prom2.get_future();
+        prom2.set_error(c11::make_error_code(c11::errc::timed_out));
+        BOOST_CHECK(fut2.get_error_code() == c11::errc::timed_out);
+        try {
+            fut2.get();
+            BOOST_CHECK(false);
+        }
+        catch (const c11::system_error& ex) {
+            BOOST_CHECK(ex.code() == c11::errc::timed_out);
+        }
+        BOOST_CHECK_EQUAL(copies, 0);
+
+        // broken promise
+        ldl::Future<Payload> fut3;
+        {
+            ldl::Promise<Payload> prom3;
+            fut3 = prom3.get_future();
+        }
+        BOOST_CHECK(fut3.get_error_code() == c11::future_errc::broken_promise);
+        BOOST_CHECK_THROW(fut3.get(), c11::system_error);
+
+        // errors pass through then() without calling fn, and exceptions thrown by fn are kept
+        int calls = 0;
+        ldl::Promise<int> prom4;
+        ldl::Future<int> fut4 = prom4.get_future().then([&calls](int x) { ++calls; return x; });
+        prom4.set_error(c11::make_error_code(c11::errc::operation_canceled));
+        BOOST_CHECK(fut4.get_error_code() == c11::errc::operation_canceled);
+        BOOST_CHECK_EQUAL(calls, 0);
+
+        ldl::Promise<void> prom5;
+        ldl::Future<int> fut5 = prom5.get_future()
+            .then([]() -> int { throw std::out_of_range("range"); })
+            .then([&calls](int x) { ++calls; return x; });
+        prom5.set_value();
+        BOOST_CHECK_THROW(fut5.get(), std::out_of_range);
+        BOOST_CHECK_EQUAL(calls, 0);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in future_error_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(shared_future_test)
+{
+    BOOST_TEST_MESSAGE("Starting shared_future_test");
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // every copy reads the same stored value, without copying it
+        int copies = 0;
+        ldl::Promise<Payload> prom;
+        ldl::SharedFuture<Payload> shared = prom.get_future().share();
+        ldl::SharedFuture<Payload> copy = shared;
+        BOOST_CHECK(shared.valid());
+        BOOST_CHECK(copy.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::timeout);
+        prom.emplace_value(9, &copies);
+        const Payload& first = shared.get();
+        const Payload& second = copy.get();
+        BOOST_CHECK_EQUAL(&first, &second);
+        BOOST_CHECK_EQUAL(first.id, 9);
+        BOOST_CHECK_EQUAL(shared.get().id, 9);
+        BOOST_CHECK_EQUAL(copies, 0);
+
+        // many threads blocked on one value are all woken
+        const int NUM_THREADS = 8;
+        ldl::Promise<std::string> prom2;
+        ldl::SharedFuture<std::string> shared2(prom2.get_future());
+        c11::atomic<int> matched(0);
+        std::vector<c11::thread> threads;
+        for (int ix = 0; ix < NUM_THREADS; ++ix) {
+            ldl::SharedFuture<std::string> own = shared2;
+            threads.push_back(c11::thread([own, &matched]() {
+                if (own.get() == "broadcast") {
+                    ++matched;
+                }
+            }));
+        }
+        c11::this_thread::sleep_for(c11::chrono::milliseconds(20));
+        prom2.set_value("broadcast");
+        for (size_t ix = 0; ix < threads.size(); ++ix) {
+            threads[ix].join();
+        }
+        BOOST_CHECK_EQUAL(matched.load(), NUM_THREADS);
+
+        // errors are thrown by every get(), and void is supported
+        ldl::SharedFuture<int> failed;
+        {
+            ldl::Promise<int> prom3;
+            failed = prom3.get_future().share();
+        }
+        BOOST_CHECK_THROW(failed.get(), c11::system_error);
+        BOOST_CHECK_THROW(failed.get(), c11::system_error);
+        BOOST_CHECK(failed.get_error_code() == c11::future_errc::broken_promise);
+
+        ldl::Promise<void> prom4;
+        ldl::SharedFuture<void> done = prom4.get_future().share();
+        prom4.set_value();
+        done.get();
+        BOOST_CHECK(!done.has_error());
+
+        ldl::SharedFuture<int> invalid;
+        BOOST_CHECK_THROW(invalid.get(), std::runtime_error);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in shared_future_test: " << ex.what());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,267 @@
+#include "heap_sampler.h"
+
+#include <algorithm> // sort
+#include <atomic>
+#include <cmath> // exp, log
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+namespace c11 {
+    using namespace std;
+}
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h> // CaptureStackBackTrace
+#elif defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h> // backtrace
+#define LDL_HAVE_BACKTRACE
+#endif
+
+namespace ldl {
+
+    namespace {
+
+        // number of slots in the filter used to skip unsampled blocks in RecordPush() (power of 2)
+        const size_t FILTER_SIZE = 4096;
+
+        // identifies an allocation call site
+        struct SiteKey {
+            size_t block_size;
+            std::vector<void*> stack;
+            bool operator<(const SiteKey& other) const {
+                return (block_size < other.block_size) || (block_size == other.block_size && stack < other.stack);
+            }
+        };
+
+        // type of map of call sites
+        typedef std::map<SiteKey, HeapSampleSite> SiteMap;
+
+        // a sampled block that has not been pushed back yet.
+        struct LiveSample {
+            HeapSampleSite* site;
+            size_t weight;
+        };
+
+        // type of map of live samples, keyed by block address.
+        typedef std::map<void*, LiveSample> LiveMap;
+
+        // state of the sampler shared by all threads (protected by mutex)
+        struct SamplerState {
+            c11::mutex mutex;
+            SiteMap sites;
+            LiveMap live;
+        };
+
+        // per-thread sampling state
+        struct ThreadState {
+            bool initialized;
+            size_t bytes_until_sample;
+            c11::minstd_rand rng;
+        };
+
+        // bytes between samples (0 = disabled)
+        c11::atomic<size_t> sample_interval_(0);
+
+        // number of live samples whose address hashes to each slot.
+        c11::atomic<unsigned> filter_[FILTER_SIZE];
+
+        //--------------
+        // constructed on first use, so blocks can be sampled during static initialization.
+        SamplerState& GetState()
+        {
+            static SamplerState state;
+            return state;
+        }
+
+        //--------------
+        ThreadState& GetThreadState()
+        {
+            static thread_local ThreadState state = { false, 0, c11::minstd_rand() };
+            return state;
+        }
+
+        //--------------
+        // return the filter slot of a block address
+        c11::atomic<unsigned>& FilterSlot(void* ptr)
+        {
+            c11::uintptr_t bits = reinterpret_cast<c11::uintptr_t>(ptr);
+            return filter_[((bits >> 3) ^ (bits >> 15)) & (FILTER_SIZE - 1)];
+        }
+
+        //--------------
+        // return number of bytes to allocate before taking the next sample.
+        // Exponentially distributed, so that every byte allocated has the same chance to be sampled.
+        size_t NextSampleDistance(ThreadState& state, size_t sample_interval)
+        {
+            size_t retval = 0; // sample every allocation if sample_interval == 1
+            if (sample_interval > 1) {
+                c11::uniform_real_distribution<double> uniform(0.0, 1.0);
+                retval = static_cast<size_t>(-std::log(1.0 - uniform(state.rng)) * sample_interval);
+            }
+            return retval;
+        }
+
+        //--------------
+        // return the number of bytes allocated that one sample of a block_size block represents.
+        size_t SampleWeight(size_t block_size, size_t sample_interval)
+        {
+            size_t retval = block_size;
+            if (sample_interval > 1) {
+                double probability = 1.0 - std::exp(-static_cast<double>(block_size) / sample_interval);
+                retval = static_cast<size_t>(block_size / probability + 0.5);
+            }
+            return retval;
+        }
+
+        //--------------
+        // copy the return addresses of the current call stack into frames, skipping the sampler's own frames.
+        size_t CaptureStack(void** frames, size_t max_frames)
+        {
+            size_t retval = 0;
+#if defined(_WIN32)
+            retval = CaptureStackBackTrace(3, static_cast<DWORD>(max_frames), frames, 0);
+#elif defined(LDL_HAVE_BACKTRACE)
+            void* buffer[HeapSampler::MAX_FRAMES + 3];
+            int num_frames = backtrace(buffer, static_cast<int>(max_frames + 3));
+            for (int ix = 3; ix < num_frames; ++ix) {
+                frames[retval++] = buffer[ix];
+            }
+#endif
+            return retval;
+        }
+
+        //--------------
+        bool GreaterLiveBytes(const HeapSampleSite& lhs, const HeapSampleSite& rhs)
+        {
+            return (lhs.live_bytes > rhs.live_bytes) || (lhs.live_bytes == rhs.live_bytes && lhs.total_bytes > rhs.total_bytes);
+        }
+
+    } // namespace
+
+    //--------------
+    void HeapSampler::SetSampleInterval(size_t sample_interval)
+    {
+        sample_interval_.store(sample_interval, c11::memory_order_relaxed);
+    }
+
+    //--------------
+    size_t HeapSampler::GetSampleInterval()
+    {
+        return sample_interval_.load(c11::memory_order_relaxed);
+    }
+
+    //--------------
+    void HeapSampler::RecordPop(size_t block_size, void* ptr)
+    {
+        size_t sample_interval = sample_interval_.load(c11::memory_order_relaxed);
+        if (sample_interval == 0 || !ptr) { // sampling disabled
+            return;
+        }
+        ThreadState& state = GetThreadState();
+        if (!state.initialized) {
+            state.rng.seed(static_cast<unsigned>(c11::hash<c11::thread::id>()(c11::this_thread::get_id())));
+            state.bytes_until_sample = NextSampleDistance(state, sample_interval);
+            state.initialized = true;
+        }
+        if (state.bytes_until_sample >= block_size) { // not sampled
+            state.bytes_until_sample -= block_size;
+            return;
+        }
+        state.bytes_until_sample = NextSampleDistance(state, sample_interval);
+        Sample(block_size, ptr);
+    }
+
+    //--------------
+    void HeapSampler::RecordPush(void* ptr)
+    {
+        if (!ptr || FilterSlot(ptr).load(c11::memory_order_relaxed) == 0) { // definitely not sampled
+            return;
+        }
+        SamplerState& state = GetState();
+        c11::lock_guard<c11::mutex> lock(state.mutex);
+        LiveMap::iterator it = state.live.find(ptr);
+        if (it != state.live.end()) {
+            --it->second.site->live_samples;
+            it->second.site->live_bytes -= it->second.weight;
+            state.live.erase(it);
+            FilterSlot(ptr).fetch_sub(1, c11::memory_order_relaxed);
+        }
+    }
+
+    //--------------
+    void HeapSampler::GetProfile(std::vector<HeapSampleSite>& sites)
+    {
+        SamplerState& state = GetState();
+        c11::lock_guard<c11::mutex> lock(state.mutex);
+        sites.clear();
+        for (SiteMap::const_iterator it = state.sites.begin(); it != state.sites.end(); ++it) {
+            sites.push_back(it->second);
+        }
+    }
+
+    //--------------
+    void HeapSampler::WriteProfile(std::ostream& os)
+    {
+        std::vector<HeapSampleSite> sites;
+        GetProfile(sites);
+        std::sort(sites.begin(), sites.end(), GreaterLiveBytes);
+        os << "heap profile: sample_interval=" << GetSampleInterval() << "\n";
+        for (std::vector<HeapSampleSite>::const_iterator it = sites.begin(); it != sites.end(); ++it) {
+            os << it->live_bytes << " " << it->live_samples << " "
+                << it->total_bytes << " " << it->total_samples << " "
+                << it->block_size << " @";
+            for (std::vector<void*>::const_iterator frame = it->stack.begin(); frame != it->stack.end(); ++frame) {
+                os << " " << *frame;
+            }
+            os << "\n";
+        }
+    }
+
+    //--------------
+    void HeapSampler::Reset()
+    {
+        SamplerState& state = GetState();
+        c11::lock_guard<c11::mutex> lock(state.mutex);
+        state.live.clear();
+        state.sites.clear();
+        for (size_t ix = 0; ix < FILTER_SIZE; ++ix) {
+            filter_[ix].store(0, c11::memory_order_relaxed);
+        }
+    }
+
+    //--------------
+    void HeapSampler::Sample(size_t block_size, void* ptr)
+    {
+        SiteKey key;
+        key.block_size = block_size;
+        void* frames[MAX_FRAMES];
+        key.stack.assign(frames, frames + CaptureStack(frames, MAX_FRAMES));
+        size_t weight = SampleWeight(block_size, GetSampleInterval());
+
+        SamplerState& state = GetState();
+        c11::lock_guard<c11::mutex> lock(state.mutex);
+        HeapSampleSite& site = state.sites[key];
+        if (site.total_samples == 0) { // new site
+            site.block_size = block_size;
+            site.stack = key.stack;
+        }
+        ++site.live_samples;
+        site.live_bytes += weight;
+        ++site.total_samples;
+        site.total_bytes += weight;
+        LiveSample& live = state.live[ptr];
+        if (live.site) { // block was sampled, but its push was missed (e.g. after Reset())
+            --live.site->live_samples;
+            live.site->live_bytes -= live.weight;
+        }
+        else {
+            FilterSlot(ptr).fetch_add(1, c11::memory_order_relaxed);
+        }
+        live.site = &site;
+        live.weight = weight;
+    }
+
+} //namespace ldl
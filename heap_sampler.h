@@ -0,0 +1,80 @@
+#pragma once
+#ifndef LDL_HEAP_SAMPLER_H_
+#define LDL_HEAP_SAMPLER_H_
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace ldl {
+
+    //-------------
+    /// Heap profile of one allocation call site and block size.
+    struct HeapSampleSite {
+        // block size of the sampled allocations
+        size_t block_size;
+
+        // return addresses of the call stack that allocated the blocks (innermost first)
+        std::vector<void*> stack;
+
+        // number of sampled blocks that have not been pushed back yet.
+        size_t live_samples;
+
+        // estimated number of bytes allocated at this site that have not been pushed back yet.
+        size_t live_bytes;
+
+        // number of sampled blocks since sampling was enabled.
+        size_t total_samples;
+
+        // estimated number of bytes allocated at this site since sampling was enabled.
+        size_t total_bytes;
+
+        HeapSampleSite() : block_size(0), live_samples(0), live_bytes(0), total_samples(0), total_bytes(0) {}
+    };
+
+    //-------------
+    /// Sampling profiler for blocks allocated from StaticPoolList.
+    /// Roughly one in every sample_interval bytes allocated is sampled: the call stack of the
+    /// allocation is recorded, and the block is tracked until it is pushed back to its pool.
+    /// Each sample is weighted by the number of bytes it represents, so the profile estimates
+    /// the live and cumulative bytes allocated at each call site.
+    /// Unsampled allocations cost a thread-local subtraction, and unsampled frees a relaxed
+    /// load from a small hash filter, so sampling can be left enabled in production.
+    class HeapSampler {
+    public:
+
+        // maximum number of stack frames recorded per sample.
+        static const size_t MAX_FRAMES = 32;
+
+        // sample roughly one in every sample_interval bytes allocated. 0 disables sampling (the default).
+        static void SetSampleInterval(size_t sample_interval);
+
+        // return the current sample interval.
+        static size_t GetSampleInterval();
+
+        // record the allocation of a block of block_size bytes. (called by StaticPoolList::Pop())
+        static void RecordPop(size_t block_size, void* ptr);
+
+        // record that a block is being returned to its pool. (called by StaticPoolList::Push())
+        static void RecordPush(void* ptr);
+
+        // replace the contents of sites with the profile of every sampled call site.
+        static void GetProfile(std::vector<HeapSampleSite>& sites);
+
+        // write the profile in text form: one line per site, most live bytes first,
+        //   <live_bytes> <live_samples> <total_bytes> <total_samples> <block_size> @ <return addresses>
+        // The return addresses can be symbolized offline (e.g. with addr2line or pprof).
+        static void WriteProfile(std::ostream& os);
+
+        // discard all samples.
+        static void Reset();
+
+    private:
+
+        // record a sampled allocation.
+        static void Sample(size_t block_size, void* ptr);
+    };
+
+} //namespace ldl
+
+#endif //! LDL_HEAP_SAMPLER_H_
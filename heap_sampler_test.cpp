@@ -0,0 +1,65 @@
+#include "boost/test/unit_test.hpp"
+
+#include "heap_sampler.h"
+
+#include "static_pool_list.h"
+
+#include <sstream>
+
+BOOST_AUTO_TEST_SUITE(HEAP_SAMPLER)
+BOOST_AUTO_TEST_CASE(heap_sampler_test)
+{
+    BOOST_TEST_MESSAGE("Starting heap_sampler_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+        ldl::HeapSampler::Reset();
+
+        // sampling is disabled by default
+        BOOST_CHECK_EQUAL(ldl::HeapSampler::GetSampleInterval(), 0);
+        void* ptr_a = ldl::StaticPoolList::Pop(48);
+        std::vector<ldl::HeapSampleSite> sites;
+        ldl::HeapSampler::GetProfile(sites);
+        BOOST_CHECK_EQUAL(sites.size(), 0);
+        ldl::StaticPoolList::Push(48, ptr_a);
+
+        // sample every allocation
+        ldl::HeapSampler::SetSampleInterval(1);
+        void* ptrs[5];
+        for (size_t ix = 0; ix < 5; ++ix) {
+            ptrs[ix] = ldl::StaticPoolList::Pop(48);
+        }
+        ldl::HeapSampler::GetProfile(sites);
+        BOOST_REQUIRE_EQUAL(sites.size(), 1);
+        BOOST_CHECK_EQUAL(sites[0].block_size, 48);
+        BOOST_CHECK_EQUAL(sites[0].live_samples, 5);
+        BOOST_CHECK_EQUAL(sites[0].live_bytes, 5 * 48);
+        BOOST_CHECK_EQUAL(sites[0].total_samples, 5);
+
+        for (size_t ix = 0; ix < 3; ++ix) {
+            ldl::StaticPoolList::Push(48, ptrs[ix]);
+        }
+        ldl::HeapSampler::GetProfile(sites);
+        BOOST_CHECK_EQUAL(sites[0].live_samples, 2);
+        BOOST_CHECK_EQUAL(sites[0].live_bytes, 2 * 48);
+        BOOST_CHECK_EQUAL(sites[0].total_bytes, 5 * 48);
+
+        std::ostringstream profile;
+        ldl::HeapSampler::WriteProfile(profile);
+        BOOST_CHECK_EQUAL(profile.str().find("heap profile: sample_interval=1\n96 2 240 5 48 @"), 0);
+
+        ldl::HeapSampler::SetSampleInterval(0);
+        ldl::StaticPoolList::Push(48, ptrs[3]);
+        ldl::StaticPoolList::Push(48, ptrs[4]);
+        ldl::HeapSampler::GetProfile(sites);
+        BOOST_CHECK_EQUAL(sites[0].live_samples, 0);
+
+        ldl::HeapSampler::Reset();
+        ldl::HeapSampler::GetProfile(sites);
+        BOOST_CHECK_EQUAL(sites.size(), 0);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in heap_sampler_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+#pragma once
+#ifndef LDL_INTRUSIVE_POINTER_H_
+#define LDL_INTRUSIVE_POINTER_H_
+
+#include "pooled_new.h"
+#include "ref_counted.h"
+
+#include <ostream>
+
+namespace ldl {
+
+    /// Smart pointer to an object that holds its own reference count, such as a class derived from RefCounted<T>.
+    /// T must have AddRef() and Release() members. There is no separate ownership block, so an IntrusivePointer
+    /// is one pointer, and creating one from a new object doesn't allocate anything else.
+    template<typename T>
+    class IntrusivePointer {
+    public:
+
+        /// Type of the managed pointer.
+        typedef T element_type;
+
+        //---
+
+        // Default constructor
+        IntrusivePointer();
+
+        // construct from null pointer
+        IntrusivePointer(nullptr_t);
+
+        // construct from pointer. Adds a reference to *ptr if add_ref is true.
+        // (use add_ref = false to adopt a reference that was added by the caller)
+        IntrusivePointer(T* ptr, bool add_ref = true);
+
+        // copy constructor
+        IntrusivePointer(const IntrusivePointer& other);
+
+        // copy constructor from a different IntrusivePointer specialization
+        template<typename U>
+        IntrusivePointer(const IntrusivePointer<U>& other);
+
+        // move constructor. (other is left empty)
+        IntrusivePointer(IntrusivePointer&& other) noexcept;
+
+        // move constructor from a different IntrusivePointer specialization
+        template<typename U>
+        IntrusivePointer(IntrusivePointer<U>&& other) noexcept;
+
+        // destructor
+        ~IntrusivePointer();
+
+        // Copy assignment operator
+        IntrusivePointer& operator=(const IntrusivePointer& other);
+
+        // Copy assignment operator from a different IntrusivePointer specialization
+        template<typename U>
+        IntrusivePointer& operator=(const IntrusivePointer<U>& other);
+
+        // Move assignment operator. (other is left empty)
+        IntrusivePointer& operator=(IntrusivePointer&& other) noexcept;
+
+        // swap state of two objects.
+        void swap(IntrusivePointer& other) noexcept;
+
+        // Reset object to an empty state.
+        void reset() noexcept;
+
+        // reset object and then reinitialize it as if constructed by IntrusivePointer(ptr, add_ref)
+        void reset(T* ptr, bool add_ref = true);
+
+        // return the managed pointer, and leave this object empty without releasing its reference.
+        T* detach() noexcept;
+
+        // return the managed pointer.
+        element_type* get() const;
+
+        // dereference the managed pointer
+        element_type& operator*() const;
+
+        // dereference the managed pointer for accessing its members.
+        element_type* operator->() const;
+
+        // return true if this object is managing a pointer.
+        operator bool() const;
+
+    private:
+
+        template<typename U>
+        friend class IntrusivePointer;
+
+        //----
+
+        // managed pointer
+        T* obj_ptr_;
+
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+
+    }; //IntrusivePointer<T>
+
+    // return an IntrusivePointer to a new object of type T constructed with args.
+    template<typename T, typename... Args>
+    IntrusivePointer<T> MakeIntrusive(Args&&... args);
+
+    // Equality comparison operators
+    template<typename T, typename U>
+    bool operator==(const IntrusivePointer<T>& lhs, const IntrusivePointer<U>& rhs);
+    template<typename T>
+    bool operator==(nullptr_t, const IntrusivePointer<T>& rhs);
+    template<typename T>
+    bool operator==(const IntrusivePointer<T>& lhs, nullptr_t);
+
+    // inequality comparison operators
+    template<typename T, typename U>
+    bool operator!=(const IntrusivePointer<T>& lhs, const IntrusivePointer<U>& rhs);
+    template<typename T>
+    bool operator!=(nullptr_t, const IntrusivePointer<T>& rhs);
+    template<typename T>
+    bool operator!=(const IntrusivePointer<T>& lhs, nullptr_t);
+
+    // less than comparison operator (for ordered containers)
+    template<typename T>
+    bool operator<(const IntrusivePointer<T>& lhs, const IntrusivePointer<T>& rhs);
+
+    // ostream operator
+    template<typename charT, typename traits, typename T>
+    std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>& os, const IntrusivePointer<T>& rhs);
+
+} //namespace ldl
+
+#include "intrusive_pointer.hpp"
+
+#endif //! LDL_INTRUSIVE_POINTER_H_
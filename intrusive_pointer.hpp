@@ -0,0 +1,209 @@
+#include "intrusive_pointer.h"
+
+#include <algorithm> // swap
+#include <utility> // forward
+
+namespace ldl {
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>::IntrusivePointer()
+        : obj_ptr_(0)
+    {
+    }
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>::IntrusivePointer(nullptr_t)
+        : obj_ptr_(0)
+    {
+    }
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>::IntrusivePointer(T* ptr, bool add_ref)
+        : obj_ptr_(ptr)
+    {
+        if (obj_ptr_ && add_ref) {
+            obj_ptr_->AddRef();
+        }
+    }
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>::IntrusivePointer(const IntrusivePointer& other)
+        : obj_ptr_(other.obj_ptr_)
+    {
+        if (obj_ptr_) {
+            obj_ptr_->AddRef();
+        }
+    }
+
+    //-----------------
+    template<typename T>
+    template<typename U>
+    IntrusivePointer<T>::IntrusivePointer(const IntrusivePointer<U>& other)
+        : obj_ptr_(other.obj_ptr_)
+    {
+        if (obj_ptr_) {
+            obj_ptr_->AddRef();
+        }
+    }
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>::IntrusivePointer(IntrusivePointer&& other) noexcept
+        : obj_ptr_(other.obj_ptr_)
+    {
+        other.obj_ptr_ = 0;
+    }
+
+    //-----------------
+    template<typename T>
+    template<typename U>
+    IntrusivePointer<T>::IntrusivePointer(IntrusivePointer<U>&& other) noexcept
+        : obj_ptr_(other.obj_ptr_)
+    {
+        other.obj_ptr_ = 0;
+    }
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>::~IntrusivePointer()
+    {
+        reset();
+    }
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>& IntrusivePointer<T>::operator=(const IntrusivePointer& other)
+    {
+        IntrusivePointer(other).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T>
+    template<typename U>
+    IntrusivePointer<T>& IntrusivePointer<T>::operator=(const IntrusivePointer<U>& other)
+    {
+        IntrusivePointer(other).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>& IntrusivePointer<T>::operator=(IntrusivePointer&& other) noexcept
+    {
+        IntrusivePointer(c11::move(other)).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T>
+    void IntrusivePointer<T>::swap(IntrusivePointer& other) noexcept
+    {
+        std::swap(obj_ptr_, other.obj_ptr_);
+    }
+
+    //-----------------
+    template<typename T>
+    void IntrusivePointer<T>::reset() noexcept
+    {
+        T* obj_ptr = obj_ptr_;
+        obj_ptr_ = 0;
+        if (obj_ptr) { // release after *this is empty, in case the object owns *this
+            obj_ptr->Release();
+        }
+    }
+
+    //-----------------
+    template<typename T>
+    void IntrusivePointer<T>::reset(T* ptr, bool add_ref)
+    {
+        IntrusivePointer(ptr, add_ref).swap(*this);
+    }
+
+    //-----------------
+    template<typename T>
+    T* IntrusivePointer<T>::detach() noexcept
+    {
+        T* obj_ptr = obj_ptr_;
+        obj_ptr_ = 0;
+        return obj_ptr;
+    }
+
+    //-----------------
+    template<typename T>
+    T* IntrusivePointer<T>::get() const
+    {
+        return obj_ptr_;
+    }
+
+    //-----------------
+    template<typename T>
+    T& IntrusivePointer<T>::operator*() const
+    {
+        return *obj_ptr_;
+    }
+
+    //-----------------
+    template<typename T>
+    T* IntrusivePointer<T>::operator->() const
+    {
+        return obj_ptr_;
+    }
+
+    //-----------------
+    template<typename T>
+    IntrusivePointer<T>::operator bool() const
+    {
+        return (obj_ptr_ != 0);
+    }
+
+    //-----------------
+    template<typename T>
+    const size_t IntrusivePointer<T>::element_size_ = sizeof(IntrusivePointer<T>);
+
+    //-----------------
+    template<typename T, typename... Args>
+    IntrusivePointer<T> MakeIntrusive(Args&&... args)
+    {
+        return IntrusivePointer<T>(new T(c11::forward<Args>(args)...));
+    }
+
+    //-----------------
+    // lhs==rhs
+    template<typename T, typename U>
+    bool operator==(const IntrusivePointer<T>& lhs, const IntrusivePointer<U>& rhs) { return (lhs.get() == rhs.get()); }
+    // 0==rhs
+    template<typename T>
+    bool operator==(nullptr_t, const IntrusivePointer<T>& rhs) { return (rhs.get() == nullptr); }
+    // lhs==0
+    template<typename T>
+    bool operator==(const IntrusivePointer<T>& lhs, nullptr_t) { return (lhs.get() == nullptr); }
+
+    //-----------------
+    // lhs!=rhs
+    template<typename T, typename U>
+    bool operator!=(const IntrusivePointer<T>& lhs, const IntrusivePointer<U>& rhs) { return (lhs.get() != rhs.get()); }
+    // 0!=rhs
+    template<typename T>
+    bool operator!=(nullptr_t, const IntrusivePointer<T>& rhs) { return (rhs.get() != nullptr); }
+    // lhs!=0
+    template<typename T>
+    bool operator!=(const IntrusivePointer<T>& lhs, nullptr_t) { return (lhs.get() != nullptr); }
+
+    //-----------------
+    // lhs<rhs
+    template<typename T>
+    bool operator<(const IntrusivePointer<T>& lhs, const IntrusivePointer<T>& rhs) { return (lhs.get() < rhs.get()); }
+
+    //-----------------
+    template<typename charT, typename traits, typename T>
+    std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>& os, const IntrusivePointer<T>& rhs)
+    {
+        return (os << rhs.get());
+    }
+
+} //namespace ldl
@@ -0,0 +1,104 @@
+#include "boost/test/unit_test.hpp"
+
+#include "intrusive_pointer.h"
+
+#include "pooled_new.h"
+#include "ref_counted.h"
+#include "static_pool_list.h"
+
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    int deleted_count = 0;
+
+    // pooled message that holds its own reference count
+    struct Message : public ldl::PooledNew<Message>, public ldl::RefCounted<Message> {
+        Message(int a, int b) : value(a + b) {}
+        ~Message() { ++deleted_count; }
+        int value;
+        char payload[40];
+    };
+
+} //namespace
+
+BOOST_AUTO_TEST_SUITE(INTRUSIVE_POINTER)
+
+BOOST_AUTO_TEST_CASE(intrusive_pointer_test)
+{
+    BOOST_TEST_MESSAGE("Starting intrusive_pointer_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // one word, no separate ownership block
+        BOOST_CHECK_EQUAL(sizeof(ldl::IntrusivePointer<Message>), sizeof(Message*));
+        BOOST_CHECK(std::is_nothrow_move_constructible<ldl::IntrusivePointer<Message> >::value);
+
+        Message::IncreasePoolSize(1);
+        size_t num_free = Message::GetPoolFree();
+        deleted_count = 0;
+
+        ldl::IntrusivePointer<Message> p1 = ldl::MakeIntrusive<Message>(3, 4);
+        BOOST_CHECK_EQUAL(Message::GetPoolFree(), num_free - 1);
+        BOOST_CHECK_EQUAL(p1->value, 7);
+        BOOST_CHECK_EQUAL(p1->GetRefCount(), 1);
+        {
+            ldl::IntrusivePointer<Message> p2(p1);
+            ldl::IntrusivePointer<Message> p3;
+            p3 = p2;
+            BOOST_CHECK_EQUAL(p1->GetRefCount(), 3);
+            BOOST_CHECK(p1 == p3);
+
+            // a raw pointer can be turned back into an owner
+            ldl::IntrusivePointer<Message> p4(p1.get());
+            BOOST_CHECK_EQUAL(p1->GetRefCount(), 4);
+        }
+        BOOST_CHECK_EQUAL(p1->GetRefCount(), 1);
+
+        // move leaves the source empty
+        ldl::IntrusivePointer<Message> p5(std::move(p1));
+        BOOST_CHECK(p1 == nullptr);
+        BOOST_CHECK_EQUAL(p5->GetRefCount(), 1);
+
+        // detach and adopt without changing the count
+        Message* raw = p5.detach();
+        BOOST_CHECK_EQUAL(raw->GetRefCount(), 1);
+        ldl::IntrusivePointer<Message> p6(raw, false);
+        BOOST_CHECK_EQUAL(p6->GetRefCount(), 1);
+
+        // last release returns the block to the pool
+        BOOST_CHECK_EQUAL(deleted_count, 0);
+        p6.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 1);
+        BOOST_CHECK_EQUAL(Message::GetPoolFree(), num_free);
+
+        // copies released by several threads
+        ldl::IntrusivePointer<Message> p7(new Message(1, 1));
+        std::atomic<int> sum(0);
+        std::vector<std::thread> threads;
+        for (size_t ix = 0; ix < 4; ++ix) {
+            threads.push_back(std::thread([p7, &sum]() {
+                for (size_t jx = 0; jx < 1000; ++jx) {
+                    ldl::IntrusivePointer<Message> copy(p7);
+                    sum += copy->value;
+                }
+            }));
+        }
+        for (size_t ix = 0; ix < threads.size(); ++ix) {
+            threads[ix].join();
+        }
+        BOOST_CHECK_EQUAL(sum.load(), 8000);
+        BOOST_CHECK_EQUAL(p7->GetRefCount(), 1);
+        p7.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 2);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in intrusive_pointer_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -41,14 +41,20 @@ namespace ldl {
         // copy constructor
         LinkedList(const LinkedList& other);
 
+        // move constructor (other is left empty)
+        LinkedList(LinkedList&& other) noexcept;
+
         // destructor
         ~LinkedList();
 
         // copy assignment
         LinkedList& operator=(const LinkedList& other);
 
+        // move assignment (other is left empty)
+        LinkedList& operator=(LinkedList&& other) noexcept;
+
         // swap contents of two objects
-        void swap(LinkedList& other);
+        void swap(LinkedList& other) noexcept;
 
         // clear list contents
         void clear();
@@ -16,6 +16,14 @@ namespace ldl {
         operator=(other);
     }
 
+    //---------------
+    template<typename T>
+    LinkedList<T>::LinkedList(LinkedList&& other) noexcept
+        : begin_(other.begin_)
+    {
+        other.begin_ = 0;
+    }
+
     //---------------
     template<typename T>
     LinkedList<T>::~LinkedList()
@@ -46,7 +54,19 @@ namespace ldl {
 
     //---------------
     template<typename T>
-    void LinkedList<T>::swap(LinkedList& other)
+    LinkedList<T>& LinkedList<T>::operator=(LinkedList&& other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            begin_ = other.begin_;
+            other.begin_ = 0;
+        }
+        return *this;
+    }
+
+    //---------------
+    template<typename T>
+    void LinkedList<T>::swap(LinkedList& other) noexcept
     {
         if (this != &other) {
             std::swap(begin_, other.begin_);
@@ -0,0 +1,171 @@
+#include "lock_profile.h"
+
+#include <map>
+
+namespace ldl {
+
+    namespace {
+
+        // type of the registry of all lock profiles, keyed by site name.
+        typedef std::map<std::string, LockProfile*> LockProfileMap;
+
+        //--------------
+        // mutex that protects the registry. (constructed on first use, so profiles can be used during static initialization)
+        c11::mutex& RegistryMutex()
+        {
+            static c11::mutex mutex;
+            return mutex;
+        }
+
+        //--------------
+        // registry of all lock profiles.
+        LockProfileMap& Registry()
+        {
+            static LockProfileMap registry;
+            return registry;
+        }
+
+    } // namespace
+
+    //--------------
+    LockProfileStats::LockProfileStats()
+        : acquisitions(0)
+        , contended(0)
+        , total_wait_ns(0)
+        , total_hold_ns(0)
+    {
+        for (size_t ix = 0; ix < NUM_BINS; ++ix) {
+            wait_histogram[ix] = 0;
+            hold_histogram[ix] = 0;
+        }
+    }
+
+    //--------------
+    LockProfile& LockProfile::Get(const std::string& site)
+    {
+        c11::lock_guard<c11::mutex> lock(RegistryMutex());
+        LockProfile*& retval = Registry()[site];
+        if (!retval) {
+            retval = new LockProfile(site); // never deleted, references must stay valid
+        }
+        return *retval;
+    }
+
+    //--------------
+    void LockProfile::GetAll(std::vector<LockProfileStats>& stats)
+    {
+        c11::lock_guard<c11::mutex> lock(RegistryMutex());
+        stats.clear();
+        for (LockProfileMap::const_iterator it = Registry().begin(); it != Registry().end(); ++it) {
+            stats.push_back(it->second->GetStats());
+        }
+    }
+
+    //--------------
+    void LockProfile::ResetAll()
+    {
+        c11::lock_guard<c11::mutex> lock(RegistryMutex());
+        for (LockProfileMap::iterator it = Registry().begin(); it != Registry().end(); ++it) {
+            it->second->Reset();
+        }
+    }
+
+    //--------------
+    void LockProfile::WriteReport(std::ostream& os)
+    {
+        std::vector<LockProfileStats> stats;
+        GetAll(stats);
+        for (std::vector<LockProfileStats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+            if (it->acquisitions == 0) {
+                continue;
+            }
+            os << it->site
+                << ": acquisitions=" << it->acquisitions
+                << " contended=" << it->contended
+                << " (" << (100.0 * it->contended / it->acquisitions) << "%)"
+                << " total_wait_ns=" << it->total_wait_ns
+                << " total_hold_ns=" << it->total_hold_ns
+                << "\n";
+            os << "  wait_ns:";
+            for (size_t ix = 0; ix < LockProfileStats::NUM_BINS; ++ix) {
+                if (it->wait_histogram[ix]) {
+                    os << " [" << (ix ? (c11::uint64_t(1) << ix) : 0) << ")=" << it->wait_histogram[ix];
+                }
+            }
+            os << "\n  hold_ns:";
+            for (size_t ix = 0; ix < LockProfileStats::NUM_BINS; ++ix) {
+                if (it->hold_histogram[ix]) {
+                    os << " [" << (ix ? (c11::uint64_t(1) << ix) : 0) << ")=" << it->hold_histogram[ix];
+                }
+            }
+            os << "\n";
+        }
+    }
+
+    //--------------
+    LockProfile::LockProfile(const std::string& site)
+        : site_(site)
+    {
+        Reset();
+    }
+
+    //--------------
+    void LockProfile::Record(bool contended, c11::uint64_t wait_ns, c11::uint64_t hold_ns)
+    {
+        acquisitions_.fetch_add(1, c11::memory_order_relaxed);
+        if (contended) {
+            contended_.fetch_add(1, c11::memory_order_relaxed);
+            total_wait_ns_.fetch_add(wait_ns, c11::memory_order_relaxed);
+            wait_histogram_[GetBin(wait_ns)].fetch_add(1, c11::memory_order_relaxed);
+        }
+        total_hold_ns_.fetch_add(hold_ns, c11::memory_order_relaxed);
+        hold_histogram_[GetBin(hold_ns)].fetch_add(1, c11::memory_order_relaxed);
+    }
+
+    //--------------
+    LockProfileStats LockProfile::GetStats() const
+    {
+        LockProfileStats retval;
+        retval.site = site_;
+        retval.acquisitions = acquisitions_.load(c11::memory_order_relaxed);
+        retval.contended = contended_.load(c11::memory_order_relaxed);
+        retval.total_wait_ns = total_wait_ns_.load(c11::memory_order_relaxed);
+        retval.total_hold_ns = total_hold_ns_.load(c11::memory_order_relaxed);
+        for (size_t ix = 0; ix < LockProfileStats::NUM_BINS; ++ix) {
+            retval.wait_histogram[ix] = wait_histogram_[ix].load(c11::memory_order_relaxed);
+            retval.hold_histogram[ix] = hold_histogram_[ix].load(c11::memory_order_relaxed);
+        }
+        return retval;
+    }
+
+    //--------------
+    void LockProfile::Reset()
+    {
+        acquisitions_.store(0, c11::memory_order_relaxed);
+        contended_.store(0, c11::memory_order_relaxed);
+        total_wait_ns_.store(0, c11::memory_order_relaxed);
+        total_hold_ns_.store(0, c11::memory_order_relaxed);
+        for (size_t ix = 0; ix < LockProfileStats::NUM_BINS; ++ix) {
+            wait_histogram_[ix].store(0, c11::memory_order_relaxed);
+            hold_histogram_[ix].store(0, c11::memory_order_relaxed);
+        }
+    }
+
+    //--------------
+    const std::string& LockProfile::GetSite() const
+    {
+        return site_;
+    }
+
+    //--------------
+    size_t LockProfile::GetBin(c11::uint64_t ns)
+    {
+        size_t retval = 0;
+        while (ns > 1 && retval < LockProfileStats::NUM_BINS - 1) {
+            ns >>= 1;
+            ++retval;
+        }
+        return retval;
+    }
+
+} //namespace ldl
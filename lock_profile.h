@@ -0,0 +1,164 @@
+#pragma once
+#ifndef LDL_LOCK_PROFILE_H_
+#define LDL_LOCK_PROFILE_H_
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Snapshot of the counters of a LockProfile.
+    struct LockProfileStats {
+        // number of histogram bins. bin k counts durations in [2^k, 2^(k+1)) nanoseconds. (bin 0 also counts 0)
+        static const size_t NUM_BINS = 32;
+
+        // name of the lock site
+        std::string site;
+
+        // number of times the lock was acquired.
+        c11::uint64_t acquisitions;
+
+        // number of acquisitions that had to wait because the lock was already held.
+        c11::uint64_t contended;
+
+        // total time spent waiting for the lock (nanoseconds)
+        c11::uint64_t total_wait_ns;
+
+        // total time the lock was held (nanoseconds)
+        c11::uint64_t total_hold_ns;
+
+        // histogram of wait times of contended acquisitions.
+        c11::uint64_t wait_histogram[NUM_BINS];
+
+        // histogram of hold times.
+        c11::uint64_t hold_histogram[NUM_BINS];
+
+        LockProfileStats();
+    };
+
+    //-------------
+    /// Class that accumulates contention statistics for one lock site.
+    /// Profiles are created on demand by Get(), are never destroyed, and are updated
+    /// by ProfiledLockGuard objects from any number of threads.
+    class LockProfile {
+    public:
+
+        // return the profile of the named lock site, creating it if necessary.
+        // Looking up a profile takes a lock, so callers should cache the returned reference.
+        static LockProfile& Get(const std::string& site);
+
+        // replace the contents of stats with a snapshot of every profile, in order of site name.
+        static void GetAll(std::vector<LockProfileStats>& stats);
+
+        // reset the counters of every profile.
+        static void ResetAll();
+
+        // write a text report of every profile that has been acquired at least once.
+        static void WriteReport(std::ostream& os);
+
+        //---
+
+        // record one acquisition of the lock.
+        void Record(bool contended, c11::uint64_t wait_ns, c11::uint64_t hold_ns);
+
+        // return a snapshot of the counters.
+        LockProfileStats GetStats() const;
+
+        // set all counters to zero.
+        void Reset();
+
+        // return the name of the lock site.
+        const std::string& GetSite() const;
+
+    private:
+
+        // only Get() constructs profiles
+        explicit LockProfile(const std::string& site);
+
+        // no copies allowed
+        LockProfile(const LockProfile&) = delete;
+        LockProfile& operator=(const LockProfile&) = delete;
+
+        // return the histogram bin of a duration.
+        static size_t GetBin(c11::uint64_t ns);
+
+        //---
+
+        std::string site_;
+
+        c11::atomic<c11::uint64_t> acquisitions_;
+
+        c11::atomic<c11::uint64_t> contended_;
+
+        c11::atomic<c11::uint64_t> total_wait_ns_;
+
+        c11::atomic<c11::uint64_t> total_hold_ns_;
+
+        c11::atomic<c11::uint64_t> wait_histogram_[LockProfileStats::NUM_BINS];
+
+        c11::atomic<c11::uint64_t> hold_histogram_[LockProfileStats::NUM_BINS];
+    };
+
+    //-------------
+    /// Scoped lock guard that measures how long it waited for the lock and how long it held it,
+    /// and records both in a LockProfile when it is destroyed.
+    template<typename Mutex>
+    class ProfiledLockGuard {
+    public:
+
+        // lock mutex, recording the acquisition in profile.
+        ProfiledLockGuard(Mutex& mutex, LockProfile& profile);
+
+        // unlock mutex and record the acquisition.
+        ~ProfiledLockGuard();
+
+        // also record this acquisition in profile. (e.g. to attribute a shared lock to the object it protects.)
+        void Attribute(LockProfile& profile);
+
+    private:
+        // no copies allowed
+        ProfiledLockGuard(const ProfiledLockGuard&) = delete;
+        ProfiledLockGuard& operator=(const ProfiledLockGuard&) = delete;
+
+        typedef c11::chrono::steady_clock Clock;
+
+        Mutex& mutex_;
+
+        LockProfile& profile_;
+
+        LockProfile* attributed_profile_;
+
+        bool contended_;
+
+        c11::uint64_t wait_ns_;
+
+        Clock::time_point locked_time_;
+    };
+
+} //namespace ldl
+
+//-------------
+// LDL_LOCK_GUARD(name, mutex_type, mutex, profile) declares a scoped lock guard called name.
+// If LDL_LOCK_PROFILING is defined it is a ProfiledLockGuard that records into profile,
+// otherwise it is a plain lock_guard and the profile expression is never evaluated.
+// LDL_LOCK_ATTRIBUTE(name, profile) attributes the acquisition to a second profile.
+#ifdef LDL_LOCK_PROFILING
+#define LDL_LOCK_GUARD(name, mutex_type, mutex, profile) ldl::ProfiledLockGuard<mutex_type> name((mutex), (profile))
+#define LDL_LOCK_ATTRIBUTE(name, profile) (name).Attribute(profile)
+#else
+#define LDL_LOCK_GUARD(name, mutex_type, mutex, profile) c11::lock_guard<mutex_type> name(mutex)
+#define LDL_LOCK_ATTRIBUTE(name, profile) ((void)0)
+#endif
+
+#include "lock_profile.hpp"
+
+#endif //! LDL_LOCK_PROFILE_H_
@@ -0,0 +1,46 @@
+#include "lock_profile.h"
+
+namespace ldl {
+
+    //---------------
+    template<typename Mutex>
+    ProfiledLockGuard<Mutex>::ProfiledLockGuard(Mutex& mutex, LockProfile& profile)
+        : mutex_(mutex)
+        , profile_(profile)
+        , attributed_profile_(0)
+        , contended_(false)
+        , wait_ns_(0)
+    {
+        if (!mutex_.try_lock()) { // lock is held by another thread
+            contended_ = true;
+            Clock::time_point start_time = Clock::now();
+            mutex_.lock();
+            locked_time_ = Clock::now();
+            wait_ns_ = static_cast<c11::uint64_t>(c11::chrono::duration_cast<c11::chrono::nanoseconds>(locked_time_ - start_time).count());
+        }
+        else {
+            locked_time_ = Clock::now();
+        }
+    }
+
+    //---------------
+    template<typename Mutex>
+    ProfiledLockGuard<Mutex>::~ProfiledLockGuard()
+    {
+        c11::uint64_t hold_ns = static_cast<c11::uint64_t>(c11::chrono::duration_cast<c11::chrono::nanoseconds>(Clock::now() - locked_time_).count());
+        mutex_.unlock();
+        // record after unlocking, so recording doesn't add to the hold time of the next owner.
+        profile_.Record(contended_, wait_ns_, hold_ns);
+        if (attributed_profile_) {
+            attributed_profile_->Record(contended_, wait_ns_, hold_ns);
+        }
+    }
+
+    //---------------
+    template<typename Mutex>
+    void ProfiledLockGuard<Mutex>::Attribute(LockProfile& profile)
+    {
+        attributed_profile_ = &profile;
+    }
+
+} //namespace ldl
@@ -0,0 +1,104 @@
+#include "boost/test/unit_test.hpp"
+
+#include "lock_profile.h"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <mutex>
+namespace c11 {
+    using namespace std;
+}
+
+namespace {
+
+    // mutex that announces when a thread failed to take it and is about to block in lock().
+    struct AnnouncingMutex {
+        AnnouncingMutex() : waiting(false) {}
+
+        bool try_lock()
+        {
+            bool retval = mutex.try_lock();
+            if (!retval) {
+                waiting.store(true);
+            }
+            return retval;
+        }
+
+        void lock() { mutex.lock(); }
+
+        void unlock() { mutex.unlock(); }
+
+        c11::mutex mutex;
+        c11::atomic<bool> waiting;
+    };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(LOCK_PROFILE)
+BOOST_AUTO_TEST_CASE(lock_profile_test)
+{
+    BOOST_TEST_MESSAGE("Starting lock_profile_test");
+
+    try {
+        ldl::LockProfile& profile = ldl::LockProfile::Get("lock_profile_test");
+        BOOST_CHECK_EQUAL(&profile, &ldl::LockProfile::Get("lock_profile_test"));
+        BOOST_CHECK_EQUAL(profile.GetSite(), "lock_profile_test");
+        profile.Reset();
+
+        ldl::LockProfile& attributed = ldl::LockProfile::Get("lock_profile_test[1]");
+        attributed.Reset();
+
+        AnnouncingMutex mutex;
+        {
+            ldl::ProfiledLockGuard<AnnouncingMutex> lock(mutex, profile);
+        }
+        ldl::LockProfileStats stats = profile.GetStats();
+        BOOST_CHECK_EQUAL(stats.acquisitions, 1);
+        BOOST_CHECK_EQUAL(stats.contended, 0);
+        BOOST_CHECK_EQUAL(stats.total_wait_ns, 0);
+
+        // hold the lock until another thread has found it taken and is about to wait for it
+        c11::thread th;
+        {
+            ldl::ProfiledLockGuard<AnnouncingMutex> lock(mutex, profile);
+            th = c11::thread([&]() {
+                ldl::ProfiledLockGuard<AnnouncingMutex> lock2(mutex, profile);
+                lock2.Attribute(attributed);
+            });
+            while (!mutex.waiting.load()) {
+                c11::this_thread::yield();
+            }
+        }
+        th.join();
+
+        stats = profile.GetStats();
+        BOOST_CHECK_EQUAL(stats.acquisitions, 3);
+        BOOST_CHECK_EQUAL(stats.contended, 1);
+        BOOST_CHECK_GT(stats.total_wait_ns, 0);
+        BOOST_CHECK_GT(stats.total_hold_ns, 0);
+        c11::uint64_t wait_count = 0;
+        c11::uint64_t hold_count = 0;
+        for (size_t ix = 0; ix < ldl::LockProfileStats::NUM_BINS; ++ix) {
+            wait_count += stats.wait_histogram[ix];
+            hold_count += stats.hold_histogram[ix];
+        }
+        BOOST_CHECK_EQUAL(wait_count, 1);
+        BOOST_CHECK_EQUAL(hold_count, 3);
+
+        ldl::LockProfileStats attributed_stats = attributed.GetStats();
+        BOOST_CHECK_EQUAL(attributed_stats.acquisitions, 1);
+        BOOST_CHECK_EQUAL(attributed_stats.contended, 1);
+
+        std::ostringstream report;
+        ldl::LockProfile::WriteReport(report);
+        BOOST_CHECK_NE(report.str().find("lock_profile_test: acquisitions=3 contended=1"), std::string::npos);
+
+        ldl::LockProfile::ResetAll();
+        BOOST_CHECK_EQUAL(profile.GetStats().acquisitions, 0);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in lock_profile_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,13 +8,74 @@ namespace c11 {
     using namespace std;
 }
 
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h> // VirtualLock
+#else
+#include <sys/mman.h> // mlock
+#include <unistd.h> // sysconf
+#endif
+
 namespace ldl {
 
+    namespace {
+
+        //--------------
+        // return the size of a virtual memory page.
+        size_t PageSize()
+        {
+#ifdef _WIN32
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<size_t>(info.dwPageSize);
+#else
+            return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        }
+
+        //--------------
+        // write to every page spanned by a block.
+        void PrefaultBlock(void* ptr, size_t size)
+        {
+            static const size_t page_size = PageSize();
+            volatile char* bytes = static_cast<volatile char*>(ptr);
+            for (size_t offset = 0; offset < size; offset += page_size) {
+                bytes[offset] = 0;
+            }
+            bytes[size - 1] = 0;
+        }
+
+        //--------------
+        // lock the pages spanned by a block in physical memory.
+        bool LockBlock(void* ptr, size_t size)
+        {
+#ifdef _WIN32
+            return (VirtualLock(ptr, size) != 0);
+#else
+            return (mlock(ptr, size) == 0);
+#endif
+        }
+
+        //--------------
+        // unlock the pages spanned by a block.
+        void UnlockBlock(void* ptr, size_t size)
+        {
+#ifdef _WIN32
+            VirtualUnlock(ptr, size);
+#else
+            munlock(ptr, size);
+#endif
+        }
+
+    } // namespace
+
     //--------------
     Pool::Pool()
         : block_size_(0)
         , growth_step_(0)
         , tos_(0)
+        , real_time_(false)
+        , memory_locked_(false)
     {}
 
     //--------------
@@ -32,13 +93,26 @@ namespace ldl {
     //-----------------
     void Pool::Reset()
     {
+        // locks don't nest, so unlocking a block also unlocks the pages it shares with its neighbours.
+        // Only unlock once every block is back in the pool, and leave the pages locked otherwise.
+        if (memory_locked_ && tos_ == stack_.size()) {
+            for (size_t ix = 0; ix < tos_; ++ix) {
+                UnlockBlock(stack_[ix], block_size_);
+            }
+        }
         while (!IsEmpty()) {
-            delete[] Pop();
+            void* ptr = Pop();
+            delete[] static_cast<c11::uint64_t*>(ptr);
         }
         block_size_ = 0;
         growth_step_ = 0;
         tos_ = 0;
         stack_.clear();
+        real_time_ = false;
+        memory_locked_ = false;
+        num_blocks_.Set(0);
+        in_use_.Set(0);
+        ResetStats();
     }
 
     //-----------------
@@ -49,6 +123,16 @@ namespace ldl {
             std::swap(growth_step_, other.growth_step_);
             std::swap(tos_, other.tos_);
             std::swap(stack_, other.stack_);
+            std::swap(real_time_, other.real_time_);
+            std::swap(memory_locked_, other.memory_locked_);
+            num_blocks_.swap(other.num_blocks_);
+            in_use_.swap(other.in_use_);
+            peak_in_use_.swap(other.peak_in_use_);
+            pops_.swap(other.pops_);
+            pushes_.swap(other.pushes_);
+            growth_events_.swap(other.growth_events_);
+            misses_.swap(other.misses_);
+            lock_failures_.swap(other.lock_failures_);
         }
     }
 
@@ -61,6 +145,11 @@ namespace ldl {
         block_size_ = block_size;
         growth_step_ = growth_step;
         tos_ = 0;
+        real_time_ = false;
+        memory_locked_ = false;
+        num_blocks_.Set(0);
+        in_use_.Set(0);
+        ResetStats();
         if (num_blocks) {
             IncreaseSize(num_blocks);
         }
@@ -75,8 +164,16 @@ namespace ldl {
         for (size_t ix = 0; ix < num_blocks; ++ix) {
             // for each new element allocate raw memory from the heap and push it onto the stack
             // allocate uint64_t to get 64-bit alignment for all blocks (round up)
-            Push(new c11::uint64_t[padded_block_size]);
+            void* ptr = new c11::uint64_t[padded_block_size];
+            if (real_time_) {
+                PrefaultBlock(ptr, block_size_);
+            }
+            if (memory_locked_ && !LockBlock(ptr, block_size_)) {
+                lock_failures_.Add();
+            }
+            stack_[tos_++] = ptr;
         }
+        num_blocks_.Add(num_blocks);
     }
 
     //-----------------
@@ -120,7 +217,11 @@ namespace ldl {
     {
         void* retval = 0;
         if (IsEmpty()) { //if stack is empty
-            if (growth_step_ > 0) { // growth_step is an increment
+            misses_.Add();
+            if (real_time_) { // no growth allowed in real-time mode
+                throw std::bad_alloc();
+            }
+            else if (growth_step_ > 0) { // growth_step is an increment
                 //  add growth_step_ elements to stack_
                 IncreaseSize(static_cast<size_t>(growth_step_));
             }
@@ -131,20 +232,132 @@ namespace ldl {
             else { // growth_step == 0 // no growth allowed
                 throw std::bad_alloc();
             }
+            growth_events_.Add();
         }
         retval = stack_[--tos_]; // get ptr from front of stack
+        pops_.Add();
+        in_use_.Add();
+        if (in_use_.Get() > peak_in_use_.Get()) {
+            peak_in_use_.Set(in_use_.Get());
+        }
         return retval;
     }
 
     //-----------------
     void Pool::Push(void* ptr)
     {
-        if (tos_ >= stack_.size() && growth_step_ == 0) {
-            throw std::bad_alloc();
+        bool foreign = false;
+        if (tos_ >= stack_.size()) { // stack is full, so ptr wasn't allocated by this pool
+            misses_.Add();
+            if (growth_step_ == 0 || real_time_) {
+                throw std::bad_alloc();
+            }
+            foreign = true;
         }
         if (ptr) {
+            if (foreign) {
+                stack_.push_back(0); // make room for ptr
+                num_blocks_.Add(); // ptr becomes one of our blocks
+            }
+            else {
+                in_use_.Subtract();
+            }
             stack_[tos_++] = ptr;
+            pushes_.Add();
+        }
+    }
+
+    //-----------------
+    bool Pool::SetRealTime(bool real_time, bool lock_memory)
+    {
+        bool retval = true;
+        real_time_ = real_time;
+        if (real_time_) {
+            Prefault();
+            if (lock_memory && !memory_locked_) {
+                retval = LockMemory();
+            }
+        }
+        return retval;
+    }
+
+    //-----------------
+    bool Pool::IsRealTime() const
+    {
+        return real_time_;
+    }
+
+    //-----------------
+    bool Pool::IsMemoryLocked() const
+    {
+        return memory_locked_;
+    }
+
+    //-----------------
+    void Pool::Prefault()
+    {
+        for (size_t ix = 0; ix < tos_; ++ix) {
+            PrefaultBlock(stack_[ix], block_size_);
+        }
+    }
+
+    //-----------------
+    bool Pool::LockMemory()
+    {
+        bool retval = true;
+        for (size_t ix = 0; ix < tos_ && retval; ++ix) {
+            retval = LockBlock(stack_[ix], block_size_);
         }
+        if (!retval) {
+            lock_failures_.Add();
+        }
+        // keep track of the blocks so they are unlocked when the pool is reset
+        memory_locked_ = true;
+        return retval;
+    }
+
+    //-----------------
+    size_t Pool::GetMissCount() const
+    {
+        return misses_.Get();
+    }
+
+    //-----------------
+    void Pool::ResetMissCount()
+    {
+        misses_.Set(0);
+    }
+
+    //-----------------
+    PoolStats Pool::GetStats() const
+    {
+        PoolStats retval;
+        retval.block_size = block_size_;
+        retval.num_blocks = num_blocks_.Get();
+        retval.in_use = in_use_.Get();
+        // in_use may be updated between the two reads, never report more than num_blocks.
+        retval.free_blocks = (retval.num_blocks > retval.in_use) ? (retval.num_blocks - retval.in_use) : 0;
+        retval.peak_in_use = peak_in_use_.Get();
+        retval.bytes_reserved = retval.num_blocks * block_size_;
+        retval.pops = pops_.Get();
+        retval.pushes = pushes_.Get();
+        retval.growth_events = growth_events_.Get();
+        retval.misses = misses_.Get();
+        retval.lock_failures = lock_failures_.Get();
+        retval.growth_step = growth_step_;
+        retval.real_time = real_time_;
+        return retval;
+    }
+
+    //-----------------
+    void Pool::ResetStats()
+    {
+        pops_.Set(0);
+        pushes_.Set(0);
+        growth_events_.Set(0);
+        misses_.Set(0);
+        lock_failures_.Set(0);
+        peak_in_use_.Set(in_use_.Get());
     }
 
 } //namespace ldl
@@ -2,6 +2,8 @@
 #ifndef LDL_POOL_H_
 #define LDL_POOL_H_
 
+#include "pool_stats.h" // PoolStats
+
 #include <vector>
 
 namespace ldl {
@@ -27,6 +29,8 @@ namespace ldl {
         // reset pool to a default state.
         void Reset();
 
+        // add num_blocks blocks to the pool. If the pool's memory is locked the new blocks are locked too,
+        // and a block the OS refuses to lock is counted in PoolStats::lock_failures.
         void IncreaseSize(size_t num_blocks);
 
         /// Set number of blocks to automatically add to stack_ if it becomes empty.
@@ -60,9 +64,42 @@ namespace ldl {
         // If stack is full and growth_step==0, throw an exception.
         void Push(void* ptr);
 
+        /// Enable or disable real-time mode.
+        // In real-time mode all free blocks are prefaulted (and locked in physical memory if lock_memory is true),
+        // blocks added later by IncreaseSize() are treated the same way, and the pool never grows automatically:
+        // a Pop() from an empty pool or a Push() onto a full pool is counted as a miss and throws std::bad_alloc.
+        // Returns false if lock_memory was requested but the OS refused to lock the blocks.
+        bool SetRealTime(bool real_time, bool lock_memory = false);
+
+        // return true if the pool is in real-time mode.
+        bool IsRealTime() const;
+
+        // return true if the blocks of the pool are locked in physical memory.
+        bool IsMemoryLocked() const;
+
+        // write to every page of every unallocated block, so that using them later can't cause a page fault.
+        void Prefault();
+
+        // lock every unallocated block in physical memory. Returns false (and counts a lock failure) if the OS refused.
+        bool LockMemory();
+
+        // return number of Pop() calls that found the pool empty plus Push() calls that found it full.
+        // (i.e. the number of times the pool had to grow, or would have if growth was allowed.)
+        size_t GetMissCount() const;
+
+        // set the miss count to zero.
+        void ResetMissCount();
+
+        // return a snapshot of the statistics counters of the pool.
+        // The counters can be read without holding the lock that protects the pool, but then
+        // the snapshot is not guaranteed to be consistent, and growth_step and real_time may be stale.
+        PoolStats GetStats() const;
+
+        // set pops, pushes, growth_events, misses and lock_failures to zero, and peak_in_use to the current in_use value.
+        void ResetStats();
+
     private:
 
-        /// Increase stack_ size by num_blocks blocks.
         // no copies allowed
         Pool(const Pool&) = delete;
         Pool& operator=(const Pool&) = delete;
@@ -81,6 +118,30 @@ namespace ldl {
         // Stack of pointers to allocated block_size_ byte memory blocks
         std::vector<void*> stack_;
 
+        // true if automatic growth is forbidden and new blocks are prefaulted.
+        bool real_time_;
+
+        // true if blocks are locked in physical memory.
+        bool memory_locked_;
+
+        //---- statistics counters. (see PoolStats)
+
+        PoolCounter num_blocks_;
+
+        PoolCounter in_use_;
+
+        PoolCounter peak_in_use_;
+
+        PoolCounter pops_;
+
+        PoolCounter pushes_;
+
+        PoolCounter growth_events_;
+
+        PoolCounter misses_;
+
+        PoolCounter lock_failures_;
+
     }; // class Pool
 
 } //namespace ldl
@@ -0,0 +1,511 @@
+// pool_bench: microbenchmarks of the pooled allocators against malloc/operator new.
+// Runs each allocator and allocation pattern with 1, 2, 4, ... max_threads threads, and reports
+// ns per allocate/free pair (per thread), throughput, scaling relative to the first thread count, and RSS.
+//
+// usage: pool_bench [max_threads] [iterations_per_thread]
+
+#include "static_pool_list.h"
+#include "pool.h"
+#include "pool_list.h"
+#include "pool_allocator.h"
+#include "pooled_new.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib> // atoi, malloc, free
+#include <functional> // less
+#include <iostream>
+#include <iomanip>
+#include <list>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+namespace c11 {
+    using namespace std;
+}
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h> // GetProcessMemoryInfo
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h> // sysconf
+#endif
+
+namespace {
+
+    // size of the blocks allocated by all patterns
+    const size_t BLOCK_SIZE = 64;
+
+    // number of elements in the arrays allocated by the array new benchmarks
+    const size_t ARRAY_SIZE = 4;
+
+    // number of blocks allocated before they are freed by the LIFO and FIFO patterns
+    const size_t BATCH_SIZE = 256;
+
+    // number of live blocks in the random pattern
+    const size_t WINDOW_SIZE = 4096;
+
+    // largest number of blocks allocated at once in the bursty pattern
+    const size_t MAX_BURST_SIZE = 8192;
+
+    // number of slots in the producer/consumer queues (power of 2)
+    const size_t QUEUE_SIZE = 1024;
+
+    // growth_step of the pools
+    const int GROWTH_STEP = 1024;
+
+    //==================
+
+    // object allocated by PooledNew
+    struct PooledObject : public ldl::PooledNew<PooledObject> {
+        char data[BLOCK_SIZE];
+    };
+
+    // object allocated by the global operator new
+    struct PlainObject {
+        char data[BLOCK_SIZE];
+    };
+
+    //--------------
+    // return the resident set size of the process (bytes), or 0 if it isn't available.
+    size_t GetResidentBytes()
+    {
+        size_t retval = 0;
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            retval = counters.WorkingSetSize;
+        }
+#else
+        std::FILE* file = std::fopen("/proc/self/statm", "r");
+        if (file) {
+            unsigned long size = 0;
+            unsigned long resident = 0;
+            if (std::fscanf(file, "%lu %lu", &size, &resident) == 2) {
+                retval = static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            }
+            std::fclose(file);
+        }
+#endif
+        return retval;
+    }
+
+    //--------------
+    // xorshift random number generator. Cheap enough not to disturb the measurements.
+    class Random {
+    public:
+        explicit Random(unsigned seed) : state_(seed * 2654435761u + 1) {}
+        size_t operator()(size_t n) {
+            state_ ^= state_ << 13;
+            state_ ^= state_ >> 17;
+            state_ ^= state_ << 5;
+            return state_ % n;
+        }
+    private:
+        c11::uint32_t state_;
+    };
+
+    //--------------
+    // single producer, single consumer queue of blocks, for frees on another thread.
+    class BlockQueue {
+    public:
+        BlockQueue() : head_(0), tail_(0) {}
+
+        void Push(void* ptr) {
+            size_t tail = tail_.load(c11::memory_order_relaxed);
+            while (tail - head_.load(c11::memory_order_acquire) == QUEUE_SIZE) {
+                c11::this_thread::yield();
+            }
+            slots_[tail & (QUEUE_SIZE - 1)] = ptr;
+            tail_.store(tail + 1, c11::memory_order_release);
+        }
+
+        void* Pop() {
+            size_t head = head_.load(c11::memory_order_relaxed);
+            while (tail_.load(c11::memory_order_acquire) == head) {
+                c11::this_thread::yield();
+            }
+            void* retval = slots_[head & (QUEUE_SIZE - 1)];
+            head_.store(head + 1, c11::memory_order_release);
+            return retval;
+        }
+
+    private:
+        c11::atomic<size_t> head_;
+        char padding_[64];
+        c11::atomic<size_t> tail_;
+        void* slots_[QUEUE_SIZE];
+    };
+
+    //--------------
+    // state shared by the threads of one benchmark run.
+    struct BenchContext {
+        size_t thread_index;
+        size_t iterations;
+        c11::atomic<size_t>* ready;
+        c11::atomic<bool>* go;
+        BlockQueue* queues;
+
+        // called by each thread when it is ready to start timing.
+        void WaitForStart() const {
+            ready->fetch_add(1);
+            while (!go->load(c11::memory_order_acquire)) {
+                c11::this_thread::yield();
+            }
+        }
+    };
+
+    //==================
+    // Allocators. Each thread constructs its own instance.
+    // SHARED is true if blocks may be freed by a different thread than the one that allocated them.
+
+    struct MallocBench {
+        static const bool SHARED = true;
+        void* Allocate() {
+            void* retval = std::malloc(BLOCK_SIZE);
+            if (!retval) {
+                throw std::bad_alloc();
+            }
+            return retval;
+        }
+        void Free(void* ptr) { std::free(ptr); }
+    };
+
+    struct NewBench {
+        static const bool SHARED = true;
+        void* Allocate() { return new PlainObject; }
+        void Free(void* ptr) { delete static_cast<PlainObject*>(ptr); }
+    };
+
+    struct ArrayNewBench {
+        static const bool SHARED = true;
+        void* Allocate() { return new PlainObject[ARRAY_SIZE]; }
+        void Free(void* ptr) { delete[] static_cast<PlainObject*>(ptr); }
+    };
+
+    // thread-private Pool (Pool is not thread-safe)
+    struct PoolBench {
+        static const bool SHARED = false;
+        PoolBench() : pool_(BLOCK_SIZE, 0, GROWTH_STEP) {}
+        void* Allocate() { return pool_.Pop(); }
+        void Free(void* ptr) { pool_.Push(ptr); }
+        ldl::Pool pool_;
+    };
+
+    // thread-private PoolList (PoolList is not thread-safe)
+    struct PoolListBench {
+        static const bool SHARED = false;
+        PoolListBench() { pool_list_.SetPoolGrowthStep(BLOCK_SIZE, GROWTH_STEP); }
+        void* Allocate() { return pool_list_.Pop(BLOCK_SIZE); }
+        void Free(void* ptr) { pool_list_.Push(BLOCK_SIZE, ptr); }
+        ldl::PoolList pool_list_;
+    };
+
+    struct StaticPoolListBench {
+        static const bool SHARED = true;
+        void* Allocate() { return ldl::StaticPoolList::Pop(BLOCK_SIZE); }
+        void Free(void* ptr) { ldl::StaticPoolList::Push(BLOCK_SIZE, ptr); }
+    };
+
+    struct PooledNewBench {
+        static const bool SHARED = true;
+        void* Allocate() { return new PooledObject; }
+        void Free(void* ptr) { delete static_cast<PooledObject*>(ptr); }
+    };
+
+    struct PooledArrayNewBench {
+        static const bool SHARED = true;
+        void* Allocate() { return new PooledObject[ARRAY_SIZE]; }
+        void Free(void* ptr) { delete[] static_cast<PooledObject*>(ptr); }
+    };
+
+    //==================
+    // Allocation patterns. Each returns the number of allocate/free pairs done by the thread.
+
+    //--------------
+    // allocate a batch, and free it in reverse order.
+    template<typename Alloc>
+    size_t RunLifo(BenchContext& context)
+    {
+        Alloc alloc;
+        void* ptrs[BATCH_SIZE];
+        context.WaitForStart();
+        size_t retval = 0;
+        for (; retval < context.iterations; retval += BATCH_SIZE) {
+            for (size_t ix = 0; ix < BATCH_SIZE; ++ix) {
+                ptrs[ix] = alloc.Allocate();
+                *static_cast<char*>(ptrs[ix]) = 0;
+            }
+            for (size_t ix = BATCH_SIZE; ix-- > 0;) {
+                alloc.Free(ptrs[ix]);
+            }
+        }
+        return retval;
+    }
+
+    //--------------
+    // allocate a batch, and free it in the same order.
+    template<typename Alloc>
+    size_t RunFifo(BenchContext& context)
+    {
+        Alloc alloc;
+        void* ptrs[BATCH_SIZE];
+        context.WaitForStart();
+        size_t retval = 0;
+        for (; retval < context.iterations; retval += BATCH_SIZE) {
+            for (size_t ix = 0; ix < BATCH_SIZE; ++ix) {
+                ptrs[ix] = alloc.Allocate();
+                *static_cast<char*>(ptrs[ix]) = 0;
+            }
+            for (size_t ix = 0; ix < BATCH_SIZE; ++ix) {
+                alloc.Free(ptrs[ix]);
+            }
+        }
+        return retval;
+    }
+
+    //--------------
+    // keep a window of live blocks, and replace a random one each iteration.
+    template<typename Alloc>
+    size_t RunRandom(BenchContext& context)
+    {
+        Alloc alloc;
+        Random random(static_cast<unsigned>(context.thread_index));
+        std::vector<void*> ptrs(WINDOW_SIZE);
+        for (size_t ix = 0; ix < WINDOW_SIZE; ++ix) {
+            ptrs[ix] = alloc.Allocate();
+        }
+        context.WaitForStart();
+        size_t retval = 0;
+        for (; retval < context.iterations; ++retval) {
+            size_t ix = random(WINDOW_SIZE);
+            alloc.Free(ptrs[ix]);
+            ptrs[ix] = alloc.Allocate();
+            *static_cast<char*>(ptrs[ix]) = 0;
+        }
+        for (size_t ix = 0; ix < WINDOW_SIZE; ++ix) {
+            alloc.Free(ptrs[ix]);
+        }
+        return retval;
+    }
+
+    //--------------
+    // allocate bursts of random size, and free each burst at once.
+    template<typename Alloc>
+    size_t RunBursty(BenchContext& context)
+    {
+        Alloc alloc;
+        Random random(static_cast<unsigned>(context.thread_index));
+        std::vector<void*> ptrs(MAX_BURST_SIZE);
+        context.WaitForStart();
+        size_t retval = 0;
+        while (retval < context.iterations) {
+            size_t burst_size = 1 + random(MAX_BURST_SIZE);
+            for (size_t ix = 0; ix < burst_size; ++ix) {
+                ptrs[ix] = alloc.Allocate();
+                *static_cast<char*>(ptrs[ix]) = 0;
+            }
+            for (size_t ix = 0; ix < burst_size; ++ix) {
+                alloc.Free(ptrs[ix]);
+            }
+            retval += burst_size;
+        }
+        return retval;
+    }
+
+    //--------------
+    // even threads allocate blocks and pass them to the next odd thread, which frees them.
+    template<typename Alloc>
+    size_t RunProducerConsumer(BenchContext& context)
+    {
+        Alloc alloc;
+        BlockQueue& queue = context.queues[context.thread_index / 2];
+        bool is_producer = (context.thread_index % 2 == 0);
+        context.WaitForStart();
+        for (size_t ix = 0; ix < context.iterations; ++ix) {
+            if (is_producer) {
+                void* ptr = alloc.Allocate();
+                *static_cast<char*>(ptr) = 0;
+                queue.Push(ptr);
+            }
+            else {
+                alloc.Free(queue.Pop());
+            }
+        }
+        return is_producer ? context.iterations : 0; // count each pair once
+    }
+
+    //--------------
+    // push_back a batch of elements to a list, and pop them from the front.
+    template<typename List>
+    size_t RunList(BenchContext& context)
+    {
+        List list;
+        context.WaitForStart();
+        size_t retval = 0;
+        for (; retval < context.iterations; retval += BATCH_SIZE) {
+            for (size_t ix = 0; ix < BATCH_SIZE; ++ix) {
+                list.push_back(static_cast<int>(ix));
+            }
+            while (!list.empty()) {
+                list.pop_front();
+            }
+        }
+        return retval;
+    }
+
+    //--------------
+    // insert a batch of random keys into a map, and erase them.
+    template<typename Map>
+    size_t RunMap(BenchContext& context)
+    {
+        Map map;
+        Random random(static_cast<unsigned>(context.thread_index));
+        context.WaitForStart();
+        size_t retval = 0;
+        for (; retval < context.iterations; retval += BATCH_SIZE) {
+            for (size_t ix = 0; ix < BATCH_SIZE; ++ix) {
+                map.insert(typename Map::value_type(static_cast<int>(random(1u << 30)), static_cast<int>(ix)));
+            }
+            while (!map.empty()) {
+                map.erase(map.begin());
+            }
+        }
+        return retval;
+    }
+
+    //==================
+
+    // type of a function that runs a benchmark on one thread.
+    typedef size_t (*BenchFunction)(BenchContext& context);
+
+    // a benchmark to run.
+    struct Benchmark {
+        std::string allocator;
+        std::string pattern;
+        BenchFunction function;
+        bool paired; // threads work in producer/consumer pairs
+    };
+
+    //--------------
+    void AddBenchmark(std::vector<Benchmark>& benchmarks, const char* allocator, const char* pattern,
+        BenchFunction function, bool paired = false)
+    {
+        Benchmark benchmark = { allocator, pattern, function, paired };
+        benchmarks.push_back(benchmark);
+    }
+
+    //--------------
+    // add all allocation patterns of an allocator.
+    template<typename Alloc>
+    void AddAllocator(std::vector<Benchmark>& benchmarks, const char* allocator)
+    {
+        AddBenchmark(benchmarks, allocator, "lifo", &RunLifo<Alloc>);
+        AddBenchmark(benchmarks, allocator, "fifo", &RunFifo<Alloc>);
+        AddBenchmark(benchmarks, allocator, "random", &RunRandom<Alloc>);
+        AddBenchmark(benchmarks, allocator, "bursty", &RunBursty<Alloc>);
+        if (Alloc::SHARED) {
+            AddBenchmark(benchmarks, allocator, "producer/consumer", &RunProducerConsumer<Alloc>, true);
+        }
+    }
+
+    //--------------
+    // run function on num_threads threads. Returns the elapsed time (seconds), and the number of pairs in ops.
+    double Run(BenchFunction function, size_t num_threads, size_t iterations, size_t& ops)
+    {
+        c11::atomic<size_t> ready(0);
+        c11::atomic<bool> go(false);
+        std::vector<BlockQueue> queues((num_threads + 1) / 2);
+        std::vector<BenchContext> contexts(num_threads);
+        std::vector<size_t> thread_ops(num_threads, 0);
+        std::vector<c11::thread> threads;
+        for (size_t ix = 0; ix < num_threads; ++ix) {
+            BenchContext context = { ix, iterations, &ready, &go, &queues[0] };
+            contexts[ix] = context;
+            threads.push_back(c11::thread([&contexts, &thread_ops, function, ix]() {
+                thread_ops[ix] = function(contexts[ix]);
+            }));
+        }
+        while (ready.load() < num_threads) {
+            c11::this_thread::yield();
+        }
+        c11::chrono::steady_clock::time_point start_time = c11::chrono::steady_clock::now();
+        go.store(true, c11::memory_order_release);
+        for (size_t ix = 0; ix < num_threads; ++ix) {
+            threads[ix].join();
+        }
+        double retval = c11::chrono::duration<double>(c11::chrono::steady_clock::now() - start_time).count();
+        ops = 0;
+        for (size_t ix = 0; ix < num_threads; ++ix) {
+            ops += thread_ops[ix];
+        }
+        return retval;
+    }
+
+} // namespace
+
+//--------------
+int main(int argc, char* argv[])
+{
+    size_t max_threads = c11::thread::hardware_concurrency();
+    if (argc > 1) {
+        max_threads = static_cast<size_t>(std::atoi(argv[1]));
+    }
+    if (max_threads == 0) {
+        max_threads = 1;
+    }
+    size_t iterations = (argc > 2) ? static_cast<size_t>(std::atoi(argv[2])) : 1000000;
+
+    ldl::StaticPoolList::SetPoolGrowthStep(0, GROWTH_STEP);
+
+    typedef std::list<int> StdList;
+    typedef std::list<int, ldl::PoolAllocator<int> > PooledList;
+    typedef std::map<int, int> StdMap;
+    typedef std::map<int, int, std::less<int>, ldl::PoolAllocator<std::pair<const int, int> > > PooledMap;
+
+    std::vector<Benchmark> benchmarks;
+    AddAllocator<MallocBench>(benchmarks, "malloc");
+    AddAllocator<NewBench>(benchmarks, "new");
+    AddAllocator<PoolBench>(benchmarks, "Pool");
+    AddAllocator<PoolListBench>(benchmarks, "PoolList");
+    AddAllocator<StaticPoolListBench>(benchmarks, "StaticPoolList");
+    AddAllocator<PooledNewBench>(benchmarks, "PooledNew");
+    AddAllocator<ArrayNewBench>(benchmarks, "new[]");
+    AddAllocator<PooledArrayNewBench>(benchmarks, "PooledNew[]");
+    AddBenchmark(benchmarks, "std::allocator", "std::list", &RunList<StdList>);
+    AddBenchmark(benchmarks, "PoolAllocator", "std::list", &RunList<PooledList>);
+    AddBenchmark(benchmarks, "std::allocator", "std::map", &RunMap<StdMap>);
+    AddBenchmark(benchmarks, "PoolAllocator", "std::map", &RunMap<PooledMap>);
+
+    std::cout << std::left << std::setw(16) << "allocator" << std::setw(19) << "pattern" << std::right
+        << std::setw(8) << "threads" << std::setw(10) << "ns/op" << std::setw(10) << "Mops/s"
+        << std::setw(9) << "scaling" << std::setw(10) << "rss_MB" << "\n";
+    std::cout << std::fixed;
+    for (std::vector<Benchmark>::const_iterator it = benchmarks.begin(); it != benchmarks.end(); ++it) {
+        double base_throughput = 0;
+        for (size_t num_threads = it->paired ? 2 : 1; num_threads <= max_threads; num_threads *= 2) {
+            size_t ops = 0;
+            double elapsed = Run(it->function, num_threads, iterations, ops);
+            // ns/op is the time per allocate/free pair seen by each thread. (paired threads share one pair)
+            size_t working_threads = it->paired ? num_threads / 2 : num_threads;
+            double ns_per_op = (ops > 0) ? elapsed * 1E9 * working_threads / ops : 0;
+            double throughput = (elapsed > 0) ? ops / elapsed / 1E6 : 0;
+            if (base_throughput == 0) {
+                base_throughput = throughput;
+            }
+            std::cout << std::left << std::setw(16) << it->allocator << std::setw(19) << it->pattern << std::right
+                << std::setw(8) << num_threads
+                << std::setw(10) << std::setprecision(1) << ns_per_op
+                << std::setw(10) << std::setprecision(2) << throughput
+                << std::setw(9) << std::setprecision(2) << (base_throughput > 0 ? throughput / base_throughput : 0)
+                << std::setw(10) << std::setprecision(1) << GetResidentBytes() / 1E6
+                << std::endl;
+        }
+    }
+    return 0;
+}
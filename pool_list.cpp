@@ -7,6 +7,9 @@ namespace ldl {
     //--------------
     PoolList::PoolList()
         : default_growth_step_(0)
+        , default_real_time_(false)
+        , default_lock_memory_(false)
+        , miss_count_(0)
     {}
 
     //--------------
@@ -14,6 +17,9 @@ namespace ldl {
     {
         if (this != &other) {
             std::swap(default_growth_step_, other.default_growth_step_);
+            std::swap(default_real_time_, other.default_real_time_);
+            std::swap(default_lock_memory_, other.default_lock_memory_);
+            std::swap(miss_count_, other.miss_count_);
             pool_map_.swap(other.pool_map_);
         }
     }
@@ -23,6 +29,9 @@ namespace ldl {
     {
         pool_map_.clear();
         default_growth_step_ = 0;
+        default_real_time_ = false;
+        default_lock_memory_ = false;
+        miss_count_ = 0;
     }
 
     //--------------
@@ -40,14 +49,12 @@ namespace ldl {
     //--------------
     Pool& PoolList::GetPool(size_t block_size)
     {
-        if (block_size == 0 || block_size > MAX_BLOCK_SIZE_) {
-            throw std::runtime_error("Invalid block_size argument");
-        }
-        if (!HasPool(block_size)) { // pool doesn't exist
-            // construct a new (empty) Pool object
-            pool_map_[block_size].Initialize(block_size, 0, default_growth_step_); // empty pool
+        if (default_real_time_ && !HasPool(block_size)) {
+            // creating a pool would allocate memory
+            ++miss_count_;
+            throw std::bad_alloc();
         }
-        return pool_map_.at(block_size);
+        return CreatePool(block_size);
     }
 
     //--------------
@@ -62,7 +69,7 @@ namespace ldl {
     //--------------
     void PoolList::IncreasePoolSize(size_t block_size, size_t num_blocks)
     {
-        GetPool(block_size).IncreaseSize(num_blocks); // GetPool() may create the pool
+        CreatePool(block_size).IncreaseSize(num_blocks); // CreatePool() may create the pool
     }
 
     //--------------
@@ -77,7 +84,7 @@ namespace ldl {
             }
         }
         else { //set only pool_list[block_size]
-            GetPool(block_size).SetGrowthStep(growth_step); // GetPool() may create the pool
+            CreatePool(block_size).SetGrowthStep(growth_step); // CreatePool() may create the pool
         }
     }
 
@@ -133,4 +140,89 @@ namespace ldl {
         GetPool(block_size).Push(ptr); // GetPool() may create the pool
     }
 
+    //--------------
+    bool PoolList::SetPoolRealTime(size_t block_size, bool real_time, bool lock_memory)
+    {
+        bool retval = true;
+        if (block_size == 0) { // set default, and all pools
+            default_real_time_ = real_time;
+            default_lock_memory_ = (real_time && lock_memory);
+            for (PoolMap::iterator it = pool_map_.begin(); it != pool_map_.end(); ++it) {
+                retval = it->second.SetRealTime(real_time, lock_memory) && retval;
+            }
+        }
+        else { //set only pool_list[block_size]
+            retval = CreatePool(block_size).SetRealTime(real_time, lock_memory); // CreatePool() may create the pool
+        }
+        return retval;
+    }
+
+    //--------------
+    bool PoolList::GetPoolRealTime(size_t block_size) const
+    {
+        bool retval = default_real_time_;
+        if (HasPool(block_size)) {
+            retval = GetPool(block_size).IsRealTime();
+        }
+        return retval;
+    }
+
+    //--------------
+    size_t PoolList::GetPoolMissCount(size_t block_size) const
+    {
+        size_t retval = 0;
+        if (block_size == 0) { // total of all pools
+            retval = miss_count_;
+            for (PoolMap::const_iterator it = pool_map_.begin(); it != pool_map_.end(); ++it) {
+                retval += it->second.GetMissCount();
+            }
+        }
+        else if (HasPool(block_size)) {
+            retval = GetPool(block_size).GetMissCount();
+        }
+        return retval;
+    }
+
+    //--------------
+    PoolStats PoolList::GetPoolStats(size_t block_size) const
+    {
+        PoolStats retval;
+        if (HasPool(block_size)) {
+            retval = GetPool(block_size).GetStats();
+        }
+        else {
+            retval.block_size = block_size;
+            retval.growth_step = default_growth_step_;
+            retval.real_time = default_real_time_;
+        }
+        return retval;
+    }
+
+    //--------------
+    void PoolList::GetStats(std::vector<PoolStats>& stats) const
+    {
+        stats.clear();
+        stats.reserve(pool_map_.size());
+        for (PoolMap::const_iterator it = pool_map_.begin(); it != pool_map_.end(); ++it) {
+            stats.push_back(it->second.GetStats());
+        }
+    }
+
+    //--------------
+    Pool& PoolList::CreatePool(size_t block_size)
+    {
+        if (block_size == 0 || block_size > MAX_BLOCK_SIZE_) {
+            throw std::runtime_error("Invalid block_size argument");
+        }
+        if (!HasPool(block_size)) { // pool doesn't exist
+            // construct a new (empty) Pool object
+            Pool& pool = pool_map_[block_size];
+            pool.Initialize(block_size, 0, default_growth_step_); // empty pool
+            if (default_real_time_) {
+                pool.SetRealTime(true, default_lock_memory_);
+            }
+        }
+        return pool_map_.at(block_size);
+    }
+
 } //namespace ldl
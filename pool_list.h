@@ -5,6 +5,7 @@
 #include "pool.h"
 
 #include <map>
+#include <vector>
 
 namespace ldl {
 
@@ -30,7 +31,8 @@ namespace ldl {
         bool HasPool(size_t block_size) const;
 
         /// Return a reference to pool_list[block_size]
-        /// Will create an empty pool with default_growth_step if it doesn't already exist.
+        /// Will create an empty pool with default_growth_step if it doesn't already exist,
+        /// unless real-time mode is enabled for all pools, in which case a miss is counted and std::bad_alloc is thrown.
         Pool& GetPool(size_t block_size);
 
         /// Return a const reference to pool_list[block_size]. Throws if the pool doesn't exist.
@@ -66,14 +68,49 @@ namespace ldl {
         // push a block onto pool_list[block_size]
         void Push(size_t block_size, void* ptr);
 
+        // Enable or disable real-time mode for pool_list[block_size]. (see Pool::SetRealTime())
+        // Using block_size = 0 sets real-time mode for all current and future pools, and also forbids
+        // GetPool(), Pop() and Push() from creating new pools. Pools must then be created by IncreasePoolSize().
+        // Returns false if lock_memory was requested but the OS refused to lock some of the blocks.
+        bool SetPoolRealTime(size_t block_size, bool real_time, bool lock_memory = false);
+
+        // Return true if pool_list[block_size] is in real-time mode.
+        // setting block_size=0 returns true if real-time mode is enabled for all pools.
+        bool GetPoolRealTime(size_t block_size) const;
+
+        // Return the number of Pop() and Push() calls on pool_list[block_size] that had to grow the pool, or
+        // would have if growth was allowed.
+        // setting block_size=0 returns the total for all pools, plus calls that were refused because
+        // they would have created a new pool in real-time mode.
+        size_t GetPoolMissCount(size_t block_size) const;
+
+        // return a snapshot of the statistics counters of pool_list[block_size].
+        // Returns a zeroed PoolStats with the default policy if the pool doesn't exist.
+        PoolStats GetPoolStats(size_t block_size) const;
+
+        // replace the contents of stats with a snapshot of every pool in the list, in order of block_size.
+        void GetStats(std::vector<PoolStats>& stats) const;
+
     private:
         // no copies
         PoolList(const PoolList&); //= delete;
         PoolList& operator=(const PoolList&); //= delete;
 
+        // Return a reference to pool_list[block_size], creating it if necessary, even in real-time mode.
+        Pool& CreatePool(size_t block_size);
+
         // default value of growth_step_ for all pools
         int default_growth_step_;
 
+        // true if real-time mode is enabled for all pools
+        bool default_real_time_;
+
+        // true if new pools have their blocks locked in physical memory.
+        bool default_lock_memory_;
+
+        // number of calls refused because they would have created a new pool in real-time mode.
+        size_t miss_count_;
+
         // type defining a map of multiple Pool objects keyed by their block_size.
         typedef std::map<size_t, Pool> PoolMap;
 
@@ -82,6 +119,36 @@ namespace ldl {
 
     }; // class PoolList
 
+    //-----------------------
+    /// Deleter for SharedPointer that destroys an object and returns its block to the PoolList it was popped from.
+    /// e.g. SharedPointer<Buffer>(new(pool_list.Pop(size)) Buffer, PoolListDeleter(pool_list, size))
+    class PoolListDeleter {
+    public:
+
+        // constructor. Blocks are pushed onto pool_list[block_size].
+        PoolListDeleter(PoolList& pool_list, size_t block_size)
+            : pool_list_(&pool_list)
+            , block_size_(block_size)
+        {
+        }
+
+        // destroy *ptr and push its block onto the PoolList.
+        template<typename U>
+        void operator()(U* ptr) const
+        {
+            ptr->~U();
+            pool_list_->Push(block_size_, ptr);
+        }
+
+    private:
+
+        // PoolList that owns the block
+        PoolList* pool_list_;
+
+        // size of the block
+        size_t block_size_;
+    }; // class PoolListDeleter
+
 } //namespace ldl
 
 #endif //! LDL_POOL_LIST_H_
@@ -153,4 +153,49 @@ BOOST_AUTO_TEST_CASE(pool_list_test)
         BOOST_TEST_MESSAGE("exception in pool_list_test: " << ex.what());
     }
 }
+
+BOOST_AUTO_TEST_CASE(pool_list_real_time_test)
+{
+    BOOST_TEST_MESSAGE("Starting pool_list_real_time_test");
+
+    try {
+        ldl::PoolList plist;
+        plist.SetPoolGrowthStep(0, 10);
+        plist.IncreasePoolSize(16, 2);
+
+        plist.SetPoolRealTime(0, true);
+        BOOST_CHECK_EQUAL(plist.GetPoolRealTime(0), true);
+        BOOST_CHECK_EQUAL(plist.GetPoolRealTime(16), true);
+        BOOST_CHECK_EQUAL(plist.GetPoolRealTime(32), true);
+
+        void* ptr_a = plist.Pop(16);
+        void* ptr_b = plist.Pop(16);
+        BOOST_CHECK_THROW(plist.Pop(16), std::bad_alloc);
+        BOOST_CHECK_EQUAL(plist.GetPoolMissCount(16), 1);
+
+        // new pools can't be created implicitly
+        BOOST_CHECK_THROW(plist.Pop(32), std::bad_alloc);
+        BOOST_CHECK_EQUAL(plist.HasPool(32), false);
+        BOOST_CHECK_EQUAL(plist.GetPoolMissCount(0), 2);
+
+        // but can be reserved explicitly
+        plist.IncreasePoolSize(32, 1);
+        BOOST_CHECK_EQUAL(plist.GetPoolRealTime(32), true);
+        void* ptr_c = plist.Pop(32);
+        BOOST_CHECK_NE(ptr_c, nullptr);
+        BOOST_CHECK_THROW(plist.Pop(32), std::bad_alloc);
+        BOOST_CHECK_EQUAL(plist.GetPoolMissCount(0), 3);
+
+        plist.Push(16, ptr_a);
+        plist.Push(16, ptr_b);
+        plist.Push(32, ptr_c);
+
+        plist.SetPoolRealTime(0, false);
+        BOOST_CHECK_EQUAL(plist.GetPoolRealTime(16), false);
+        BOOST_CHECK_NE(plist.Pop(64), nullptr);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in pool_list_real_time_test: " << ex.what());
+    }
+}
 BOOST_AUTO_TEST_SUITE_END()
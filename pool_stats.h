@@ -0,0 +1,93 @@
+#pragma once
+#ifndef LDL_POOL_STATS_H_
+#define LDL_POOL_STATS_H_
+
+#include <cstddef>
+#include <atomic>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    /// Snapshot of the statistics counters of a single Pool.
+    struct PoolStats {
+        // number of bytes in a block
+        size_t block_size;
+
+        // total number of blocks (allocated and unallocated) in the pool.
+        size_t num_blocks;
+
+        // number of unallocated blocks in the pool.
+        size_t free_blocks;
+
+        // number of blocks currently popped off of the pool.
+        size_t in_use;
+
+        // highest value of in_use since the pool was created or its stats were reset.
+        size_t peak_in_use;
+
+        // number of bytes of heap memory held by the pool.
+        size_t bytes_reserved;
+
+        // number of successful Pop() calls.
+        size_t pops;
+
+        // number of successful Push() calls.
+        size_t pushes;
+
+        // number of times the pool grew automatically.
+        size_t growth_events;
+
+        // number of Pop() and Push() calls that had to grow the pool, or would have if growth was allowed.
+        size_t misses;
+
+        // number of times the OS refused to lock blocks of the pool in physical memory. (see Pool::SetRealTime())
+        size_t lock_failures;
+
+        // growth policy of the pool. (see Pool::SetGrowthStep())
+        int growth_step;
+
+        // true if the pool is in real-time mode. (see Pool::SetRealTime())
+        bool real_time;
+
+        PoolStats()
+            : block_size(0), num_blocks(0), free_blocks(0), in_use(0), peak_in_use(0), bytes_reserved(0)
+            , pops(0), pushes(0), growth_events(0), misses(0), lock_failures(0), growth_step(0), real_time(false)
+        {}
+    };
+
+    /// Statistics counter that is updated by one thread at a time (the owner of a Pool,
+    /// or whoever holds the lock protecting it) and can be read by any thread without locking.
+    /// Because there is only ever one writer, updates are relaxed loads and stores rather than
+    /// locked read-modify-write instructions, so they cost about as much as a plain increment.
+    class PoolCounter {
+    public:
+        PoolCounter() : value_(0) {}
+
+        // add n to the counter.
+        void Add(size_t n = 1) { value_.store(value_.load(c11::memory_order_relaxed) + n, c11::memory_order_relaxed); }
+
+        // subtract n from the counter.
+        void Subtract(size_t n = 1) { value_.store(value_.load(c11::memory_order_relaxed) - n, c11::memory_order_relaxed); }
+
+        // set the counter to n.
+        void Set(size_t n) { value_.store(n, c11::memory_order_relaxed); }
+
+        // return the current value of the counter.
+        size_t Get() const { return value_.load(c11::memory_order_relaxed); }
+
+        // swap the values of two counters.
+        void swap(PoolCounter& other) { size_t tmp = Get(); Set(other.Get()); other.Set(tmp); }
+
+    private:
+        // no copies allowed
+        PoolCounter(const PoolCounter&) = delete;
+        PoolCounter& operator=(const PoolCounter&) = delete;
+
+        c11::atomic<size_t> value_;
+    };
+
+} //namespace ldl
+
+#endif //! LDL_POOL_STATS_H_
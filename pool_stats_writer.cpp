@@ -0,0 +1,192 @@
+#include "pool_stats_writer.h"
+
+#include "static_pool_list.h"
+
+#include <cstdio> // rename, remove
+#include <fstream>
+
+namespace ldl {
+
+    namespace {
+
+        //--------------
+        // write one Prometheus metric family, with one sample per pool.
+        // Values are integers, so counters keep all their digits instead of being rounded to 6 significant digits.
+        template<typename Value>
+        void WritePrometheusMetric(std::ostream& os, const std::vector<PoolStats>& stats,
+            const char* name, const char* type, const char* help, Value (*value)(const PoolStats&))
+        {
+            os << "# HELP " << name << " " << help << "\n";
+            os << "# TYPE " << name << " " << type << "\n";
+            for (std::vector<PoolStats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+                os << name << "{block_size=\"" << it->block_size << "\"} " << value(*it) << "\n";
+            }
+        }
+
+        unsigned long long NumBlocks(const PoolStats& s) { return s.num_blocks; }
+        unsigned long long FreeBlocks(const PoolStats& s) { return s.free_blocks; }
+        unsigned long long InUse(const PoolStats& s) { return s.in_use; }
+        unsigned long long PeakInUse(const PoolStats& s) { return s.peak_in_use; }
+        unsigned long long BytesReserved(const PoolStats& s) { return s.bytes_reserved; }
+        unsigned long long Pops(const PoolStats& s) { return s.pops; }
+        unsigned long long Pushes(const PoolStats& s) { return s.pushes; }
+        unsigned long long GrowthEvents(const PoolStats& s) { return s.growth_events; }
+        unsigned long long Misses(const PoolStats& s) { return s.misses; }
+        unsigned long long LockFailures(const PoolStats& s) { return s.lock_failures; }
+        long long GrowthStep(const PoolStats& s) { return s.growth_step; }
+        unsigned long long RealTime(const PoolStats& s) { return s.real_time ? 1 : 0; }
+
+    } // namespace
+
+    //--------------
+    void PoolStatsWriter::WriteJson(std::ostream& os, const std::vector<PoolStats>& stats)
+    {
+        os << "{\"pools\":[";
+        for (std::vector<PoolStats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+            if (it != stats.begin()) {
+                os << ",";
+            }
+            os << "{\"block_size\":" << it->block_size
+                << ",\"num_blocks\":" << it->num_blocks
+                << ",\"free_blocks\":" << it->free_blocks
+                << ",\"in_use\":" << it->in_use
+                << ",\"peak_in_use\":" << it->peak_in_use
+                << ",\"bytes_reserved\":" << it->bytes_reserved
+                << ",\"pops\":" << it->pops
+                << ",\"pushes\":" << it->pushes
+                << ",\"growth_events\":" << it->growth_events
+                << ",\"misses\":" << it->misses
+                << ",\"lock_failures\":" << it->lock_failures
+                << ",\"growth_step\":" << it->growth_step
+                << ",\"real_time\":" << (it->real_time ? "true" : "false")
+                << "}";
+        }
+        os << "]}\n";
+    }
+
+    //--------------
+    void PoolStatsWriter::WritePrometheus(std::ostream& os, const std::vector<PoolStats>& stats)
+    {
+        WritePrometheusMetric(os, stats, "ldl_pool_blocks", "gauge", "Total number of blocks in the pool.", NumBlocks);
+        WritePrometheusMetric(os, stats, "ldl_pool_free_blocks", "gauge", "Number of unallocated blocks in the pool.", FreeBlocks);
+        WritePrometheusMetric(os, stats, "ldl_pool_in_use_blocks", "gauge", "Number of blocks currently allocated from the pool.", InUse);
+        WritePrometheusMetric(os, stats, "ldl_pool_peak_in_use_blocks", "gauge", "Highest number of blocks allocated from the pool at once.", PeakInUse);
+        WritePrometheusMetric(os, stats, "ldl_pool_reserved_bytes", "gauge", "Heap memory held by the pool.", BytesReserved);
+        WritePrometheusMetric(os, stats, "ldl_pool_pops_total", "counter", "Number of blocks allocated from the pool.", Pops);
+        WritePrometheusMetric(os, stats, "ldl_pool_pushes_total", "counter", "Number of blocks returned to the pool.", Pushes);
+        WritePrometheusMetric(os, stats, "ldl_pool_growth_events_total", "counter", "Number of times the pool grew automatically.", GrowthEvents);
+        WritePrometheusMetric(os, stats, "ldl_pool_misses_total", "counter", "Number of requests that had to grow the pool, or would have.", Misses);
+        WritePrometheusMetric(os, stats, "ldl_pool_lock_failures_total", "counter", "Number of times the OS refused to lock blocks of the pool in memory.", LockFailures);
+        WritePrometheusMetric(os, stats, "ldl_pool_growth_step", "gauge", "Growth policy of the pool.", GrowthStep);
+        WritePrometheusMetric(os, stats, "ldl_pool_real_time", "gauge", "1 if the pool is in real-time mode.", RealTime);
+    }
+
+    //--------------
+    void PoolStatsWriter::Write(std::ostream& os, const std::vector<PoolStats>& stats, PoolStatsFormat::type format)
+    {
+        if (format == PoolStatsFormat::prometheus) {
+            WritePrometheus(os, stats);
+        }
+        else {
+            WriteJson(os, stats);
+        }
+    }
+
+    //--------------
+    void PoolStatsWriter::WriteStaticPoolList(std::ostream& os, PoolStatsFormat::type format)
+    {
+        std::vector<PoolStats> stats;
+        StaticPoolList::GetStats(stats);
+        Write(os, stats, format);
+    }
+
+    //--------------
+    bool PoolStatsWriter::DumpStaticPoolList(const std::string& filename, PoolStatsFormat::type format)
+    {
+        std::string tmp_filename = filename + ".tmp";
+        {
+            std::ofstream ofs(tmp_filename.c_str(), std::ios::out | std::ios::trunc);
+            if (!ofs) {
+                return false;
+            }
+            WriteStaticPoolList(ofs, format);
+            if (!ofs) {
+                return false;
+            }
+        } // close file before renaming it
+#ifdef _WIN32
+        // rename() doesn't replace an existing file on Windows
+        std::remove(filename.c_str());
+#endif
+        return (std::rename(tmp_filename.c_str(), filename.c_str()) == 0);
+    }
+
+    //==========================
+
+    //--------------
+    PoolStatsDumper::PoolStatsDumper()
+        : stop_(false)
+        , dump_count_(0)
+    {}
+
+    //--------------
+    PoolStatsDumper::~PoolStatsDumper()
+    {
+        Stop();
+    }
+
+    //--------------
+    void PoolStatsDumper::Start(const std::string& filename, PoolStatsFormat::type format, c11::chrono::milliseconds period)
+    {
+        Stop();
+        {
+            c11::lock_guard<c11::mutex> lock(mutex_);
+            stop_ = false;
+            dump_count_ = 0;
+        }
+        thread_ = c11::thread(&PoolStatsDumper::Run, this, filename, format, period);
+    }
+
+    //--------------
+    void PoolStatsDumper::Stop()
+    {
+        {
+            c11::lock_guard<c11::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    //--------------
+    bool PoolStatsDumper::IsRunning() const
+    {
+        c11::lock_guard<c11::mutex> lock(mutex_);
+        return (thread_.joinable() && !stop_);
+    }
+
+    //--------------
+    size_t PoolStatsDumper::GetDumpCount() const
+    {
+        c11::lock_guard<c11::mutex> lock(mutex_);
+        return dump_count_;
+    }
+
+    //--------------
+    void PoolStatsDumper::Run(std::string filename, PoolStatsFormat::type format, c11::chrono::milliseconds period)
+    {
+        c11::unique_lock<c11::mutex> lock(mutex_);
+        while (!stop_) {
+            lock.unlock(); // don't block Stop() while writing
+            bool written = PoolStatsWriter::DumpStaticPoolList(filename, format);
+            lock.lock();
+            if (written) {
+                ++dump_count_;
+            }
+            cv_.wait_for(lock, period, [this] { return stop_; }); // woken early by Stop()
+        }
+    }
+
+} //namespace ldl
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef LDL_POOL_STATS_WRITER_H_
+#define LDL_POOL_STATS_WRITER_H_
+
+#include "pool_stats.h" // PoolStats
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    // output formats supported by PoolStatsWriter
+    struct PoolStatsFormat {
+        enum type {
+            json,
+            prometheus,
+        };
+    };
+
+    //-------------
+    /// Class that serializes PoolStats snapshots for monitoring tools.
+    class PoolStatsWriter {
+    public:
+
+        // write stats as a JSON object: {"pools":[{"block_size":...,...},...]}
+        static void WriteJson(std::ostream& os, const std::vector<PoolStats>& stats);
+
+        // write stats in Prometheus text exposition format, one sample per pool labelled with its block_size.
+        static void WritePrometheus(std::ostream& os, const std::vector<PoolStats>& stats);
+
+        // write stats in the specified format.
+        static void Write(std::ostream& os, const std::vector<PoolStats>& stats, PoolStatsFormat::type format);
+
+        // take a snapshot of StaticPoolList and write it in the specified format.
+        static void WriteStaticPoolList(std::ostream& os, PoolStatsFormat::type format);
+
+        // take a snapshot of StaticPoolList and write it to filename.
+        // The file is written under a temporary name and then renamed, so a reader never sees a partial file.
+        // Returns false if the file could not be written.
+        static bool DumpStaticPoolList(const std::string& filename, PoolStatsFormat::type format);
+    };
+
+    //-------------
+    /// Class that periodically dumps a snapshot of StaticPoolList to a file, so it can be scraped
+    /// by a monitoring agent (e.g. the Prometheus node_exporter textfile collector).
+    class PoolStatsDumper {
+    public:
+
+        // default constructor (not running)
+        PoolStatsDumper();
+
+        // stops the dump thread if it is running.
+        ~PoolStatsDumper();
+
+        // start a thread that calls PoolStatsWriter::DumpStaticPoolList(filename, format) every period.
+        // Restarts the thread if it is already running.
+        void Start(const std::string& filename, PoolStatsFormat::type format, c11::chrono::milliseconds period);
+
+        // stop the dump thread and wait for it to exit.
+        void Stop();
+
+        // return true if the dump thread is running.
+        bool IsRunning() const;
+
+        // return the number of dumps written since Start() was called.
+        size_t GetDumpCount() const;
+
+    private:
+        // no copies allowed
+        PoolStatsDumper(const PoolStatsDumper&) = delete;
+        PoolStatsDumper& operator=(const PoolStatsDumper&) = delete;
+
+        // body of the dump thread.
+        void Run(std::string filename, PoolStatsFormat::type format, c11::chrono::milliseconds period);
+
+        //---
+
+        // protects stop_ and dump_count_
+        mutable c11::mutex mutex_;
+
+        // used to wake the dump thread when Stop() is called.
+        c11::condition_variable cv_;
+
+        // true when the dump thread has been asked to exit.
+        bool stop_;
+
+        // number of dumps written since Start()
+        size_t dump_count_;
+
+        // dump thread
+        c11::thread thread_;
+    };
+
+} //namespace ldl
+
+#endif //! LDL_POOL_STATS_WRITER_H_
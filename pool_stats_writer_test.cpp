@@ -0,0 +1,79 @@
+#include "boost/test/unit_test.hpp"
+
+#include "pool_stats_writer.h"
+
+#include "static_pool_list.h"
+
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+
+BOOST_AUTO_TEST_SUITE(POOL_STATS_WRITER)
+BOOST_AUTO_TEST_CASE(pool_stats_writer_test)
+{
+    BOOST_TEST_MESSAGE("Starting pool_stats_writer_test");
+
+    try {
+        std::vector<ldl::PoolStats> stats(2);
+        stats[0].block_size = 8;
+        stats[0].num_blocks = 10;
+        stats[0].free_blocks = 7;
+        stats[0].in_use = 3;
+        stats[0].growth_step = 5;
+        stats[1].block_size = 64;
+        stats[1].peak_in_use = 4;
+        stats[1].real_time = true;
+        stats[1].pops = 12345678;
+        stats[1].growth_step = -3;
+
+        std::ostringstream json;
+        ldl::PoolStatsWriter::WriteJson(json, stats);
+        BOOST_CHECK_EQUAL(json.str().find("{\"pools\":[{\"block_size\":8,\"num_blocks\":10,\"free_blocks\":7,\"in_use\":3,"), 0);
+        BOOST_CHECK_NE(json.str().find("\"growth_step\":5,\"real_time\":false}"), std::string::npos);
+        BOOST_CHECK_NE(json.str().find(",{\"block_size\":64,"), std::string::npos);
+        BOOST_CHECK_NE(json.str().find("\"real_time\":true}]}"), std::string::npos);
+
+        std::ostringstream prom;
+        ldl::PoolStatsWriter::WritePrometheus(prom, stats);
+        BOOST_CHECK_NE(prom.str().find("# TYPE ldl_pool_free_blocks gauge\n"), std::string::npos);
+        BOOST_CHECK_NE(prom.str().find("ldl_pool_free_blocks{block_size=\"8\"} 7\n"), std::string::npos);
+        BOOST_CHECK_NE(prom.str().find("ldl_pool_peak_in_use_blocks{block_size=\"64\"} 4\n"), std::string::npos);
+        BOOST_CHECK_NE(prom.str().find("# TYPE ldl_pool_pops_total counter\n"), std::string::npos);
+        BOOST_CHECK_NE(prom.str().find("ldl_pool_real_time{block_size=\"64\"} 1\n"), std::string::npos);
+        // large counters are written with all their digits
+        BOOST_CHECK_NE(prom.str().find("ldl_pool_pops_total{block_size=\"64\"} 12345678\n"), std::string::npos);
+        BOOST_CHECK_NE(prom.str().find("ldl_pool_growth_step{block_size=\"64\"} -3\n"), std::string::npos);
+
+        //---
+
+        ldl::StaticPoolList::Reset();
+        ldl::StaticPoolList::IncreasePoolSize(24, 3);
+        std::string filename = "pool_stats_writer_test.prom";
+        BOOST_CHECK_EQUAL(ldl::PoolStatsWriter::DumpStaticPoolList(filename, ldl::PoolStatsFormat::prometheus), true);
+        std::ifstream ifs(filename.c_str());
+        std::stringstream contents;
+        contents << ifs.rdbuf();
+        ifs.close();
+        BOOST_CHECK_NE(contents.str().find("ldl_pool_blocks{block_size=\"24\"} 3\n"), std::string::npos);
+
+        ldl::PoolStatsDumper dumper;
+        BOOST_CHECK_EQUAL(dumper.IsRunning(), false);
+        dumper.Start(filename, ldl::PoolStatsFormat::json, std::chrono::milliseconds(10));
+        BOOST_CHECK_EQUAL(dumper.IsRunning(), true);
+        while (dumper.GetDumpCount() < 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        dumper.Stop();
+        BOOST_CHECK_EQUAL(dumper.IsRunning(), false);
+        ifs.open(filename.c_str());
+        contents.str("");
+        contents << ifs.rdbuf();
+        ifs.close();
+        BOOST_CHECK_NE(contents.str().find("{\"block_size\":24,\"num_blocks\":3,"), std::string::npos);
+        std::remove(filename.c_str());
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in pool_stats_writer_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
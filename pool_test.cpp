@@ -124,5 +124,121 @@ BOOST_AUTO_TEST_CASE(pool_test)
         BOOST_TEST_MESSAGE("exception in pool_test: " << ex.what());
     }
 }
+
+BOOST_AUTO_TEST_CASE(pool_real_time_test)
+{
+    BOOST_TEST_MESSAGE("Starting pool_real_time_test");
+
+    try {
+        ldl::Pool pool(4096, 2, 1);
+        BOOST_CHECK_EQUAL(pool.IsRealTime(), false);
+        BOOST_CHECK_EQUAL(pool.GetMissCount(), 0);
+
+        pool.SetRealTime(true);
+        BOOST_CHECK_EQUAL(pool.IsRealTime(), true);
+        BOOST_CHECK_EQUAL(pool.GetGrowthStep(), 1);
+
+        void* ptr_a = pool.Pop();
+        void* ptr_b = pool.Pop();
+        BOOST_CHECK_EQUAL(pool.IsEmpty(), true);
+        BOOST_CHECK_EQUAL(pool.GetMissCount(), 0);
+
+        // no growth in real-time mode
+        BOOST_CHECK_THROW(pool.Pop(), std::bad_alloc);
+        BOOST_CHECK_EQUAL(pool.GetSize(), 2);
+        BOOST_CHECK_EQUAL(pool.GetMissCount(), 1);
+
+        // explicit reservations are still allowed
+        pool.IncreaseSize(1);
+        BOOST_CHECK_EQUAL(pool.GetSize(), 3);
+        BOOST_CHECK_EQUAL(pool.GetFree(), 1);
+
+        pool.Push(ptr_a);
+        pool.Push(ptr_b);
+        BOOST_CHECK_EQUAL(pool.GetFree(), 3);
+
+        // pushing a foreign block onto a full pool is a miss
+        int foreign = 0;
+        BOOST_CHECK_THROW(pool.Push(&foreign), std::bad_alloc);
+        BOOST_CHECK_EQUAL(pool.GetMissCount(), 2);
+
+        pool.ResetMissCount();
+        BOOST_CHECK_EQUAL(pool.GetMissCount(), 0);
+
+        // back to normal: growth_step is used again
+        pool.SetRealTime(false);
+        pool.Pop();
+        pool.Pop();
+        pool.Pop();
+        BOOST_CHECK_NE(pool.Pop(), nullptr);
+        BOOST_CHECK_EQUAL(pool.GetSize(), 4);
+        BOOST_CHECK_EQUAL(pool.GetMissCount(), 1);
+
+        // the OS may refuse to lock memory (e.g. because of RLIMIT_MEMLOCK), but a refusal is always counted
+        ldl::Pool locked_pool(4096, 2, 1);
+        bool locked = locked_pool.SetRealTime(true, true);
+        BOOST_CHECK_EQUAL(locked_pool.IsMemoryLocked(), true);
+        BOOST_CHECK_EQUAL(locked_pool.GetStats().lock_failures, locked ? 0 : 1);
+        locked_pool.IncreaseSize(1);
+        BOOST_CHECK(locked_pool.GetStats().lock_failures <= 2);
+        void* ptr_c = locked_pool.Pop();
+        locked_pool.Push(ptr_c);
+        locked_pool.Reset();
+        BOOST_CHECK_EQUAL(locked_pool.IsMemoryLocked(), false);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in pool_real_time_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pool_stats_test)
+{
+    BOOST_TEST_MESSAGE("Starting pool_stats_test");
+
+    try {
+        ldl::Pool pool(8, 2, 2);
+        ldl::PoolStats stats = pool.GetStats();
+        BOOST_CHECK_EQUAL(stats.block_size, 8);
+        BOOST_CHECK_EQUAL(stats.num_blocks, 2);
+        BOOST_CHECK_EQUAL(stats.free_blocks, 2);
+        BOOST_CHECK_EQUAL(stats.in_use, 0);
+        BOOST_CHECK_EQUAL(stats.bytes_reserved, 16);
+        BOOST_CHECK_EQUAL(stats.growth_step, 2);
+
+        void* ptr_a = pool.Pop();
+        void* ptr_b = pool.Pop();
+        void* ptr_c = pool.Pop(); // grows
+        stats = pool.GetStats();
+        BOOST_CHECK_EQUAL(stats.num_blocks, 4);
+        BOOST_CHECK_EQUAL(stats.free_blocks, 1);
+        BOOST_CHECK_EQUAL(stats.in_use, 3);
+        BOOST_CHECK_EQUAL(stats.peak_in_use, 3);
+        BOOST_CHECK_EQUAL(stats.pops, 3);
+        BOOST_CHECK_EQUAL(stats.growth_events, 1);
+        BOOST_CHECK_EQUAL(stats.misses, 1);
+
+        pool.Push(ptr_a);
+        pool.Push(ptr_b);
+        stats = pool.GetStats();
+        BOOST_CHECK_EQUAL(stats.in_use, 1);
+        BOOST_CHECK_EQUAL(stats.peak_in_use, 3);
+        BOOST_CHECK_EQUAL(stats.pushes, 2);
+        BOOST_CHECK_EQUAL(stats.free_blocks, pool.GetFree());
+
+        pool.ResetStats();
+        stats = pool.GetStats();
+        BOOST_CHECK_EQUAL(stats.pops, 0);
+        BOOST_CHECK_EQUAL(stats.pushes, 0);
+        BOOST_CHECK_EQUAL(stats.growth_events, 0);
+        BOOST_CHECK_EQUAL(stats.peak_in_use, 1);
+        BOOST_CHECK_EQUAL(stats.num_blocks, 4);
+
+        pool.Push(ptr_c);
+        BOOST_CHECK_EQUAL(pool.GetStats().in_use, 0);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in pool_stats_test: " << ex.what());
+    }
+}
 BOOST_AUTO_TEST_SUITE_END()
 
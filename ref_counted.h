@@ -0,0 +1,54 @@
+#pragma once
+#ifndef LDL_REF_COUNTED_H_
+#define LDL_REF_COUNTED_H_
+
+#include <atomic>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Mixin that stores a reference count inside objects of type T, for use with IntrusivePointer.
+    /// T derives from RefCounted<T> (usually together with PooledNew<T>). When the last reference is released,
+    /// the object is deleted as a T, so its memory is returned with T's operator delete.
+    /// The count is atomic, so references may be added and released by different threads.
+    template<typename T>
+    class RefCounted {
+    public:
+
+        // add a reference.
+        void AddRef() const;
+
+        // remove a reference. Deletes the object when the last reference is removed.
+        void Release() const;
+
+        // return the number of references. (relaxed load: exact only if no other thread is changing it)
+        long GetRefCount() const;
+
+    protected:
+
+        // constructor. (no references: the first IntrusivePointer adds one)
+        RefCounted();
+
+        // copy constructor. The copy has its own count, so it starts with no references.
+        RefCounted(const RefCounted& other);
+
+        // assignment doesn't change the number of references to *this.
+        RefCounted& operator=(const RefCounted& other);
+
+        // destructor (not virtual: Release() deletes the object as a T)
+        ~RefCounted();
+
+    private:
+
+        // number of references
+        mutable c11::atomic<long> ref_count_;
+    };
+
+} //namespace ldl
+
+#include "ref_counted.hpp"
+
+#endif //! LDL_REF_COUNTED_H_
@@ -0,0 +1,57 @@
+#include "ref_counted.h"
+
+namespace ldl {
+
+    //-----------------
+    template<typename T>
+    RefCounted<T>::RefCounted()
+        : ref_count_(0)
+    {
+    }
+
+    //-----------------
+    template<typename T>
+    RefCounted<T>::RefCounted(const RefCounted&)
+        : ref_count_(0)
+    {
+    }
+
+    //-----------------
+    template<typename T>
+    RefCounted<T>& RefCounted<T>::operator=(const RefCounted&)
+    {
+        return *this;
+    }
+
+    //-----------------
+    template<typename T>
+    RefCounted<T>::~RefCounted()
+    {
+    }
+
+    //-----------------
+    template<typename T>
+    void RefCounted<T>::AddRef() const
+    {
+        // a new reference is always copied from an existing one, so no ordering is needed.
+        ref_count_.fetch_add(1, c11::memory_order_relaxed);
+    }
+
+    //-----------------
+    template<typename T>
+    void RefCounted<T>::Release() const
+    {
+        // acq_rel, so that all uses of the object by other owners happen before it is deleted
+        if (ref_count_.fetch_sub(1, c11::memory_order_acq_rel) == 1) {
+            delete static_cast<const T*>(this);
+        }
+    }
+
+    //-----------------
+    template<typename T>
+    long RefCounted<T>::GetRefCount() const
+    {
+        return ref_count_.load(c11::memory_order_relaxed);
+    }
+
+} //namespace ldl
@@ -0,0 +1,251 @@
+#pragma once
+#ifndef LDL_SHARED_CONTROL_H_
+#define LDL_SHARED_CONTROL_H_
+
+#include "pooled_new.h"
+#include "deferred_reclaimer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits> // aligned_storage
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Counting policy for SharedPointer objects that may be shared between threads. (atomic counts)
+    struct AtomicCountPolicy {
+
+        /// Type of a reference count.
+        typedef c11::atomic<long> Count;
+
+        /// Base class of control blocks.
+        struct ControlBase {};
+
+        // called when the last strong owner of control is removed. Returns false: the object is destroyed inline.
+        static bool DeferRelease(ControlBase* control);
+
+        // add one to count.
+        static void Increment(Count& count);
+
+        // add one to count if it is not zero. Returns false if it was zero.
+        static bool IncrementIfNotZero(Count& count);
+
+        // subtract one from count. Returns true if it reached zero.
+        static bool Decrement(Count& count);
+
+        // return the value of count. (relaxed load: exact only if no other thread is changing it)
+        static long Load(const Count& count);
+    };
+
+    //-------------
+    /// Counting policy for SharedPointer objects that are only used by one thread at a time.
+    /// Plain counts without atomic operations or memory barriers. Owners that share an object must not be
+    /// copied or destroyed by different threads at the same time.
+    struct LocalCountPolicy {
+
+        /// Type of a reference count.
+        typedef long Count;
+
+        /// Base class of control blocks.
+        struct ControlBase {};
+
+        // called when the last strong owner of control is removed. Returns false: the object is destroyed inline.
+        static bool DeferRelease(ControlBase* control);
+
+        // add one to count.
+        static void Increment(Count& count);
+
+        // add one to count if it is not zero. Returns false if it was zero.
+        static bool IncrementIfNotZero(Count& count);
+
+        // subtract one from count. Returns true if it reached zero.
+        static bool Decrement(Count& count);
+
+        // return the value of count.
+        static long Load(const Count& count);
+    };
+
+    //-------------
+    /// Counting policy that hands the destruction of the object to the DeferredReclaimer thread when the last
+    /// strong owner is removed, so a latency-critical owner doesn't run the destructor. Falls back to destroying
+    /// the object inline if the reclaimer isn't running or its backlog is full. (atomic counts)
+    struct DeferredCountPolicy : public AtomicCountPolicy {
+
+        /// Base class of control blocks. (holds the link of the reclaimer queue)
+        typedef Reclaimable ControlBase;
+
+        // called when the last strong owner of control is removed. Returns true if control was queued.
+        static bool DeferRelease(ControlBase* control);
+    };
+
+    //-------------
+    /// Ownership state shared by all SharedPointer objects that manage the same object.
+    /// The strong count is the number of SharedPointer owners. The weak count is the number of weak owners,
+    /// plus one that is held on behalf of all strong owners, so the block outlives the managed object.
+    /// Policy is AtomicCountPolicy, LocalCountPolicy or DeferredCountPolicy.
+    template<typename Policy>
+    class BasicSharedControl : public Policy::ControlBase {
+    public:
+
+        // constructor. (one strong owner)
+        BasicSharedControl();
+
+        // add a strong owner.
+        void AddRef();
+
+        // remove a strong owner. Disposes of the managed object when the last strong owner is removed.
+        void Release();
+
+        // add a strong owner if there is at least one. Returns false if the object was already disposed of.
+        // (used to convert a weak owner to a strong owner)
+        bool AddRefIfNotZero();
+
+        // add a weak owner.
+        void AddWeakRef();
+
+        // remove a weak owner. Destroys the control block when the last weak owner is removed.
+        void ReleaseWeak();
+
+        // return the number of strong owners.
+        long GetUseCount() const;
+
+    protected:
+
+        // destructor (only called by Destroy())
+        virtual ~BasicSharedControl();
+
+        // dispose of the managed object, and remove the weak owner held by the strong owners.
+        // (called by Release(), or by the DeferredReclaimer thread if Policy deferred it)
+        void Reclaim();
+
+        // destroy the managed object.
+        virtual void Dispose() = 0;
+
+        // destroy the control block, and return its memory.
+        virtual void Destroy() = 0;
+
+    private:
+
+        // number of strong owners
+        typename Policy::Count use_count_;
+
+        // number of weak owners (+1 while use_count_ > 0)
+        typename Policy::Count weak_count_;
+
+        BasicSharedControl(const BasicSharedControl&) = delete;
+        BasicSharedControl& operator=(const BasicSharedControl&) = delete;
+    };
+
+    /// Ownership state of SharedPointer objects that may be shared between threads.
+    typedef BasicSharedControl<AtomicCountPolicy> SharedControl;
+
+    //-------------
+    /// Pooled control block for an object of type T allocated with new, and an optional delete function.
+    template<typename T, typename Policy = AtomicCountPolicy>
+    class SharedControlBlock : public BasicSharedControl<Policy> {
+    public:
+
+        /// Type of function pointer to a delete function.
+        typedef void(*DeleteFunction)(T*);
+
+        // constructor. if delete_func is null, ptr is deleted with delete.
+        SharedControlBlock(T* ptr, DeleteFunction delete_func);
+
+    protected:
+
+        // call delete_func_(ptr_), or delete ptr_.
+        virtual void Dispose();
+
+        // delete this (returns memory to its pool).
+        virtual void Destroy();
+
+    private:
+
+        // managed pointer
+        T* ptr_;
+
+        // function called to delete ptr_ (or 0)
+        DeleteFunction delete_func_;
+
+        //--
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+    };
+
+    //-------------
+    /// Pooled control block for an object of type T, and a deleter object that is stored in the block.
+    /// Deleter is any copyable function object that can be called with a T*. (for example PoolListDeleter)
+    template<typename T, typename Deleter, typename Policy = AtomicCountPolicy>
+    class SharedDeleterBlock : public BasicSharedControl<Policy> {
+    public:
+
+        // constructor. ptr is deleted by calling deleter(ptr).
+        SharedDeleterBlock(T* ptr, const Deleter& deleter);
+
+    protected:
+
+        // call deleter_(ptr_).
+        virtual void Dispose();
+
+        // delete this (destroys the deleter and returns memory to its pool).
+        virtual void Destroy();
+
+    private:
+
+        // managed pointer
+        T* ptr_;
+
+        // function object called to delete ptr_
+        Deleter deleter_;
+
+        //--
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+    };
+
+    //-------------
+    /// Pooled block that holds both the ownership state and an object of type T. (see MakeShared())
+    template<typename T, typename Policy = AtomicCountPolicy>
+    class SharedObjectBlock : public BasicSharedControl<Policy> {
+    public:
+
+        // constructor. Constructs the object with args.
+        template<typename... Args>
+        explicit SharedObjectBlock(Args&&... args);
+
+        // return a pointer to the object.
+        T* GetPointer();
+
+    protected:
+
+        // call the destructor of the object. (its memory is returned with the block)
+        virtual void Dispose();
+
+        // delete this (returns memory to its pool).
+        virtual void Destroy();
+
+    private:
+
+        // memory for the object
+        typename c11::aligned_storage<sizeof(T), alignof(T)>::type storage_;
+
+        // pool blocks are arrays of uint64_t, so storage_ can't be aligned more strictly than that.
+        static_assert(alignof(T) <= alignof(c11::uint64_t),
+            "MakeShared() can't allocate an over-aligned type from a Pool, construct a SharedPointer from new T instead");
+
+        //--
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+    };
+
+} //namespace ldl
+
+#include "shared_control.hpp"
+
+#endif //! LDL_SHARED_CONTROL_H_
@@ -0,0 +1,258 @@
+#include "shared_control.h"
+
+#include <new> // placement new
+#include <utility> // forward
+
+namespace ldl {
+
+    //-----------------
+    inline void AtomicCountPolicy::Increment(Count& count)
+    {
+        // a new owner is always copied from an existing one, so no ordering is needed.
+        count.fetch_add(1, c11::memory_order_relaxed);
+    }
+
+    //-----------------
+    inline bool AtomicCountPolicy::IncrementIfNotZero(Count& count)
+    {
+        long value = count.load(c11::memory_order_relaxed);
+        while (value != 0) {
+            if (count.compare_exchange_weak(value, value + 1, c11::memory_order_acquire, c11::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-----------------
+    inline bool AtomicCountPolicy::Decrement(Count& count)
+    {
+        // acq_rel, so that all uses of the object by other owners happen before it is destroyed
+        return (count.fetch_sub(1, c11::memory_order_acq_rel) == 1);
+    }
+
+    //-----------------
+    inline long AtomicCountPolicy::Load(const Count& count)
+    {
+        return count.load(c11::memory_order_relaxed);
+    }
+
+    //-----------------
+    inline bool AtomicCountPolicy::DeferRelease(ControlBase*)
+    {
+        return false;
+    }
+
+    //==========================
+
+    //-----------------
+    inline void LocalCountPolicy::Increment(Count& count)
+    {
+        ++count;
+    }
+
+    //-----------------
+    inline bool LocalCountPolicy::IncrementIfNotZero(Count& count)
+    {
+        if (count == 0) {
+            return false;
+        }
+        ++count;
+        return true;
+    }
+
+    //-----------------
+    inline bool LocalCountPolicy::Decrement(Count& count)
+    {
+        return (--count == 0);
+    }
+
+    //-----------------
+    inline long LocalCountPolicy::Load(const Count& count)
+    {
+        return count;
+    }
+
+    //-----------------
+    inline bool LocalCountPolicy::DeferRelease(ControlBase*)
+    {
+        return false;
+    }
+
+    //==========================
+
+    //-----------------
+    inline bool DeferredCountPolicy::DeferRelease(ControlBase* control)
+    {
+        return DeferredReclaimer::Defer(control);
+    }
+
+    //==========================
+
+    //-----------------
+    template<typename Policy>
+    BasicSharedControl<Policy>::BasicSharedControl()
+        : use_count_(1)
+        , weak_count_(1)
+    {
+    }
+
+    //-----------------
+    template<typename Policy>
+    BasicSharedControl<Policy>::~BasicSharedControl()
+    {
+    }
+
+    //-----------------
+    template<typename Policy>
+    void BasicSharedControl<Policy>::AddRef()
+    {
+        Policy::Increment(use_count_);
+    }
+
+    //-----------------
+    template<typename Policy>
+    void BasicSharedControl<Policy>::Release()
+    {
+        if (Policy::Decrement(use_count_) && !Policy::DeferRelease(this)) {
+            Reclaim();
+        }
+    }
+
+    //-----------------
+    template<typename Policy>
+    void BasicSharedControl<Policy>::Reclaim()
+    {
+        Dispose();
+        ReleaseWeak();
+    }
+
+    //-----------------
+    template<typename Policy>
+    bool BasicSharedControl<Policy>::AddRefIfNotZero()
+    {
+        return Policy::IncrementIfNotZero(use_count_);
+    }
+
+    //-----------------
+    template<typename Policy>
+    void BasicSharedControl<Policy>::AddWeakRef()
+    {
+        Policy::Increment(weak_count_);
+    }
+
+    //-----------------
+    template<typename Policy>
+    void BasicSharedControl<Policy>::ReleaseWeak()
+    {
+        if (Policy::Decrement(weak_count_)) {
+            Destroy();
+        }
+    }
+
+    //-----------------
+    template<typename Policy>
+    long BasicSharedControl<Policy>::GetUseCount() const
+    {
+        return Policy::Load(use_count_);
+    }
+
+    //==========================
+
+    //-----------------
+    template<typename T, typename Policy>
+    SharedControlBlock<T, Policy>::SharedControlBlock(T* ptr, DeleteFunction delete_func)
+        : ptr_(ptr)
+        , delete_func_(delete_func)
+    {
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void SharedControlBlock<T, Policy>::Dispose()
+    {
+        if (delete_func_) {
+            delete_func_(ptr_);
+        }
+        else {
+            delete ptr_;
+        }
+        ptr_ = 0;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void SharedControlBlock<T, Policy>::Destroy()
+    {
+        delete this;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    const size_t SharedControlBlock<T, Policy>::element_size_ = sizeof(SharedControlBlock<T, Policy>);
+
+    //==========================
+
+    //-----------------
+    template<typename T, typename Deleter, typename Policy>
+    SharedDeleterBlock<T, Deleter, Policy>::SharedDeleterBlock(T* ptr, const Deleter& deleter)
+        : ptr_(ptr)
+        , deleter_(deleter)
+    {
+    }
+
+    //-----------------
+    template<typename T, typename Deleter, typename Policy>
+    void SharedDeleterBlock<T, Deleter, Policy>::Dispose()
+    {
+        deleter_(ptr_);
+        ptr_ = 0;
+    }
+
+    //-----------------
+    template<typename T, typename Deleter, typename Policy>
+    void SharedDeleterBlock<T, Deleter, Policy>::Destroy()
+    {
+        delete this;
+    }
+
+    //-----------------
+    template<typename T, typename Deleter, typename Policy>
+    const size_t SharedDeleterBlock<T, Deleter, Policy>::element_size_ = sizeof(SharedDeleterBlock<T, Deleter, Policy>);
+
+    //==========================
+
+    //-----------------
+    template<typename T, typename Policy>
+    template<typename... Args>
+    SharedObjectBlock<T, Policy>::SharedObjectBlock(Args&&... args)
+    {
+        new(static_cast<void*>(&storage_)) T(c11::forward<Args>(args)...);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    T* SharedObjectBlock<T, Policy>::GetPointer()
+    {
+        return reinterpret_cast<T*>(&storage_);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void SharedObjectBlock<T, Policy>::Dispose()
+    {
+        GetPointer()->~T();
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void SharedObjectBlock<T, Policy>::Destroy()
+    {
+        delete this;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    const size_t SharedObjectBlock<T, Policy>::element_size_ = sizeof(SharedObjectBlock<T, Policy>);
+
+} //namespace ldl
@@ -3,25 +3,27 @@
 #define SHARED_POINTER_H
 
 #include "pooled_new.h"
-#include "pooled_mutex.h"
-#include "linkable.h"
+#include "shared_control.h"
 
-#include<mutex> // lock_guard
-namespace c11 {
-    using namespace std;
-}
+#include <type_traits> // enable_if
 
 namespace ldl {
 
-    /// Almost-duplicate of c11::shared_ptr that does not perform internal
-    /// memory allocations. Instead it uses a linked list to identify the owners of a given pointer.
-    template<typename T>
-    class SharedPointer : public Linkable {
+    /// Almost-duplicate of c11::shared_ptr that allocates its ownership state from a Pool.
+    /// The owners of a given pointer share a pooled control block with atomic reference counts,
+    /// so copying or destroying a SharedPointer is a single atomic operation.
+    /// Policy selects how the counts are updated: AtomicCountPolicy (default) for owners that may be used by
+    /// several threads, or LocalCountPolicy for owners that stay on one thread. (see LocalSharedPointer)
+    template<typename T, typename Policy = AtomicCountPolicy>
+    class SharedPointer {
     public:
 
         /// Type of the managed pointer.
         typedef T element_type;
 
+        /// Counting policy.
+        typedef Policy policy_type;
+
         /// Type of function pointer to a delete function.
         /// Not an std::function<> object because std::function<> may do internal memory allocations.
         typedef void(*DeleteFunction)(T*);
@@ -45,26 +47,53 @@ namespace ldl {
         // construct from null pointer and delete_func
         SharedPointer(nullptr_t, DeleteFunction delete_func);
 
+        // construct from pointer and a deleter object, which is copied into the pooled ownership block.
+        // ptr is deleted by calling deleter(ptr). (deleters that convert to DeleteFunction use the constructor above)
+        template<typename U, typename Deleter, typename = typename c11::enable_if<!c11::is_convertible<Deleter, DeleteFunction>::value>::type>
+        SharedPointer(U* ptr, Deleter deleter);
+
+        // aliasing constructor. Shares ownership with owner, but get() returns ptr.
+        // (for a member of the owned object, or a slice of an owned buffer)
+        template<typename U>
+        SharedPointer(const SharedPointer<U, Policy>& owner, T* ptr);
+
         // copy constructor
-        SharedPointer(SharedPointer& other);
+        SharedPointer(const SharedPointer& other);
 
         // copy constructor from a different SharedPointer specialization
         template<typename U>
-        SharedPointer(SharedPointer<U>& other);
+        SharedPointer(const SharedPointer<U, Policy>& other);
+
+        // move constructor. (other is left empty)
+        SharedPointer(SharedPointer&& other) noexcept;
+
+        // move constructor from a different SharedPointer specialization
+        template<typename U>
+        SharedPointer(SharedPointer<U, Policy>&& other) noexcept;
 
         // destructor
         ~SharedPointer();
 
         // Copy assignment operator
+        SharedPointer& operator=(const SharedPointer& other);
+
+        // Copy assignment operator from a different SharedPointer specialization
+        template<typename U>
+        SharedPointer& operator=(const SharedPointer<U, Policy>& other);
+
+        // Move assignment operator. (other is left empty)
+        SharedPointer& operator=(SharedPointer&& other) noexcept;
+
+        // Move assignment operator from a different SharedPointer specialization
         template<typename U>
-        SharedPointer& operator=(SharedPointer<U>& other);
+        SharedPointer& operator=(SharedPointer<U, Policy>&& other) noexcept;
 
         // swap state of two objects.
-        void swap(SharedPointer<T>& other);
+        void swap(SharedPointer& other) noexcept;
 
         // Reset object to an empty state.
         // Releases ownership of any currently owned object.
-        void reset();
+        void reset() noexcept;
 
         // reset object and then reinitialize it as if constructed by SharedPointer(ptr)
         template<typename U>
@@ -74,6 +103,10 @@ namespace ldl {
         template<typename U>
         void reset(U* ptr, DeleteFunction delete_func);
 
+        // reset object and then reinitialize it as if constructed by SharedPointer(ptr, deleter)
+        template<typename U, typename Deleter, typename = typename c11::enable_if<!c11::is_convertible<Deleter, DeleteFunction>::value>::type>
+        void reset(U* ptr, Deleter deleter);
+
         // return the managed pointer.
         element_type* get() const;
 
@@ -87,39 +120,39 @@ namespace ldl {
         operator bool() const;
 
         // return the number of objects holding the same pointer as *this. (0 if this object is empty)
-        long int use_count();
+        // Constant time and lock-free. If other threads are copying or resetting owners, the count may be stale.
+        long int use_count() const;
 
-        // return true if this object is the only one holding its pointer.
-        bool unique();
+        // return true if this object is the only one holding its pointer. (constant time, see use_count())
+        bool unique() const;
 
     private:
 
-        // Add specified object after *this in its list
-        // (other must be empty)
-        // if replace = true reset *this after adding other
-        void AddToList(SharedPointer& other, bool replace = false);
+        template<typename U, typename P>
+        friend class SharedPointer;
 
-        //---
+        template<typename U, typename P>
+        friend class WeakPointer;
 
-        // type of lock guard used to control mutex.
-        typedef c11::lock_guard<PooledMutex> ListLock;
+        template<typename U>
+        friend class AtomicSharedPointer;
 
-        //----
+        template<typename U, typename P, typename... Args>
+        friend SharedPointer<U, P> MakeBasicShared(Args&&... args);
 
-        // pointer to mutex (pointer makes it poolable and copyable/swapable.)
-        PooledMutex* mutex_ptr_;
+        /// Type of the ownership state.
+        typedef BasicSharedControl<Policy> Control;
 
-        // pointer to previous object in linked list of owners.
-        SharedPointer* prev_ptr_;
+        // take ownership of ptr, using control block control_ptr (which already counts *this as an owner)
+        void Attach(T* ptr, Control* control_ptr);
 
-        // pointer to next object in linked list of owners.
-        SharedPointer* next_ptr_;
+        //----
 
         // managed pointer
         T* obj_ptr_;
 
-        // pointer to static function called to delete obj_ptr_
-        DeleteFunction delete_func_;
+        // pointer to ownership state shared by all owners of obj_ptr_ (0 if empty)
+        Control* control_ptr_;
 
         static const size_t element_size_;
     public:
@@ -127,57 +160,80 @@ namespace ldl {
 
     }; //SharedPointer<T>
 
-    // Equality comparison operators
+    /// SharedPointer with plain (non-atomic) counts, for objects whose owners all stay on one thread.
     template<typename T>
-    bool operator==(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator==(nullptr_t, const SharedPointer<T>& rhs);
+    using LocalSharedPointer = SharedPointer<T, LocalCountPolicy>;
+
+    /// SharedPointer whose last owner hands the destruction of the object to the DeferredReclaimer thread.
+    /// (create with MakeBasicShared<T, DeferredCountPolicy>() to allocate the object with its ownership state)
     template<typename T>
-    bool operator==(const SharedPointer<T>& lhs, nullptr_t);
+    using DeferredSharedPointer = SharedPointer<T, DeferredCountPolicy>;
+
+    // return a SharedPointer to a new object of type T constructed with args.
+    // The object and its ownership state are allocated together, in one block from the Pool for their combined size.
+    // T must not need more alignment than uint64_t, since that is all a Pool block guarantees.
+    template<typename T, typename... Args>
+    SharedPointer<T> MakeShared(Args&&... args);
+
+    // same as MakeShared(), but returns a LocalSharedPointer.
+    template<typename T, typename... Args>
+    LocalSharedPointer<T> MakeLocalShared(Args&&... args);
+
+    // same as MakeShared(), with counting policy Policy.
+    template<typename T, typename Policy, typename... Args>
+    SharedPointer<T, Policy> MakeBasicShared(Args&&... args);
+
+    // Equality comparison operators
+    template<typename T, typename P>
+    bool operator==(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator==(nullptr_t, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator==(const SharedPointer<T, P>& lhs, nullptr_t);
 
     // inequality comparison operators
-    template<typename T>
-    bool operator!=(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator!=(nullptr_t, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator!=(const SharedPointer<T>& lhs, nullptr_t);
+    template<typename T, typename P>
+    bool operator!=(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator!=(nullptr_t, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator!=(const SharedPointer<T, P>& lhs, nullptr_t);
 
     // less than comparison operators
-    template<typename T>
-    bool operator<(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator<(nullptr_t, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator<(const SharedPointer<T>& lhs, nullptr_t);
+    template<typename T, typename P>
+    bool operator<(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator<(nullptr_t, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator<(const SharedPointer<T, P>& lhs, nullptr_t);
 
     // greater than comparison operators
-    template<typename T>
-    bool operator>(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator>(nullptr_t, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator>(const SharedPointer<T>& lhs, nullptr_t);
+    template<typename T, typename P>
+    bool operator>(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator>(nullptr_t, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator>(const SharedPointer<T, P>& lhs, nullptr_t);
 
     // greater than or equal to comparison operators.
-    template<typename T>
-    bool operator>=(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator>=(nullptr_t, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator>=(const SharedPointer<T>& lhs, nullptr_t);
+    template<typename T, typename P>
+    bool operator>=(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator>=(nullptr_t, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator>=(const SharedPointer<T, P>& lhs, nullptr_t);
 
     // less than or equal to comparison operators.
-    template<typename T>
-    bool operator<=(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator<=(nullptr_t, const SharedPointer<T>& rhs);
-    template<typename T>
-    bool operator<=(const SharedPointer<T>& lhs, nullptr_t);
+    template<typename T, typename P>
+    bool operator<=(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator<=(nullptr_t, const SharedPointer<T, P>& rhs);
+    template<typename T, typename P>
+    bool operator<=(const SharedPointer<T, P>& lhs, nullptr_t);
 
     // ostream operator
-    template<typename charT, typename traits, typename T>
-    std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>& os, const SharedPointer<T>& rhs);
+    template<typename charT, typename traits, typename T, typename P>
+    std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>& os, const SharedPointer<T, P>& rhs);
 
 } //namespace ldl
 
@@ -1,377 +1,389 @@
 #include "shared_pointer.h"
 
+#include <algorithm> // swap
+#include <utility> // forward, move
+
 namespace ldl {
 
     //-----------------
-    template<typename T>
-    SharedPointer<T>::SharedPointer()
-        : mutex_ptr_(0)
-        , prev_ptr_(0)
-        , next_ptr_(0)
-        , obj_ptr_(0)
-        , delete_func_(0)
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>::SharedPointer()
+        : obj_ptr_(0)
+        , control_ptr_(0)
     {
     }
 
     //-----------------
-    template<typename T>
+    template<typename T, typename Policy>
     template<typename U>
-    SharedPointer<T>::SharedPointer(U* ptr)
-        : mutex_ptr_(0)
-        , prev_ptr_(0)
-        , next_ptr_(0)
-        , obj_ptr_(0)
-        , delete_func_(0)
+    SharedPointer<T, Policy>::SharedPointer(U* ptr)
+        : obj_ptr_(0)
+        , control_ptr_(0)
     {
         reset(ptr);
     }
 
     //-----------------
-    template<typename T>
-    SharedPointer<T>::SharedPointer(nullptr_t)
-        : mutex_ptr_(0)
-        , prev_ptr_(0)
-        , next_ptr_(0)
-        , obj_ptr_(0)
-        , delete_func_(0)
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>::SharedPointer(nullptr_t)
+        : obj_ptr_(0)
+        , control_ptr_(0)
     {
     }
 
     //-----------------
-    template<typename T>
+    template<typename T, typename Policy>
     template<typename U>
-    SharedPointer<T>::SharedPointer(U* ptr, DeleteFunction delete_func)
-        : mutex_ptr_(0)
-        , prev_ptr_(0)
-        , next_ptr_(0)
-        , obj_ptr_(0)
-        , delete_func_(0)
+    SharedPointer<T, Policy>::SharedPointer(U* ptr, DeleteFunction delete_func)
+        : obj_ptr_(0)
+        , control_ptr_(0)
     {
+        reset(ptr, delete_func);
     }
 
     //-----------------
-    template<typename T>
-    SharedPointer<T>::SharedPointer(nullptr_t, DeleteFunction delete_func)
-        : mutex_ptr_(0)
-        , prev_ptr_(0)
-        , next_ptr_(0)
-        , obj_ptr_(0)
-        , delete_func_(0)
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>::SharedPointer(nullptr_t, DeleteFunction delete_func)
+        : obj_ptr_(0)
+        , control_ptr_(0)
     {
     }
 
     //-----------------
-    template<typename T>
-    SharedPointer<T>::SharedPointer(SharedPointer& other)
-        : mutex_ptr_(0)
-        , prev_ptr_(0)
-        , next_ptr_(0)
-        , obj_ptr_(0)
-        , delete_func_(0)
+    template<typename T, typename Policy>
+    template<typename U, typename Deleter, typename>
+    SharedPointer<T, Policy>::SharedPointer(U* ptr, Deleter deleter)
+        : obj_ptr_(0)
+        , control_ptr_(0)
     {
-        other.AddToList(*this);
+        reset(ptr, deleter);
     }
 
     //-----------------
-    template<typename T>
+    template<typename T, typename Policy>
     template<typename U>
-    SharedPointer<T>::SharedPointer(SharedPointer<U>& other)
-        : mutex_ptr_(0)
-        , prev_ptr_(0)
-        , next_ptr_(0)
-        , obj_ptr_(0)
-        , delete_func_(0)
+    SharedPointer<T, Policy>::SharedPointer(const SharedPointer<U, Policy>& owner, T* ptr)
+        : obj_ptr_(ptr)
+        , control_ptr_(owner.control_ptr_)
     {
-        other.AddToList(*this);
+        if (control_ptr_) {
+            control_ptr_->AddRef();
+        }
     }
 
     //-----------------
-    template<typename T>
-    SharedPointer<T>::~SharedPointer()
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>::SharedPointer(const SharedPointer& other)
+        : obj_ptr_(other.obj_ptr_)
+        , control_ptr_(other.control_ptr_)
     {
-        reset();
+        if (control_ptr_) {
+            control_ptr_->AddRef();
+        }
     }
 
     //-----------------
-    template<typename T>
+    template<typename T, typename Policy>
     template<typename U>
-    SharedPointer<T>& SharedPointer<T>::operator=(SharedPointer<U>& other)
+    SharedPointer<T, Policy>::SharedPointer(const SharedPointer<U, Policy>& other)
+        : obj_ptr_(other.obj_ptr_)
+        , control_ptr_(other.control_ptr_)
+    {
+        if (control_ptr_) {
+            control_ptr_->AddRef();
+        }
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>::SharedPointer(SharedPointer&& other) noexcept
+        : obj_ptr_(other.obj_ptr_)
+        , control_ptr_(other.control_ptr_)
+    {
+        other.obj_ptr_ = 0;
+        other.control_ptr_ = 0;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    template<typename U>
+    SharedPointer<T, Policy>::SharedPointer(SharedPointer<U, Policy>&& other) noexcept
+        : obj_ptr_(other.obj_ptr_)
+        , control_ptr_(other.control_ptr_)
+    {
+        other.obj_ptr_ = 0;
+        other.control_ptr_ = 0;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>::~SharedPointer()
     {
         reset();
-        other.AddToList(*this);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>& SharedPointer<T, Policy>::operator=(const SharedPointer& other)
+    {
+        SharedPointer(other).swap(*this);
         return *this;
     }
 
     //-----------------
-    template<typename T>
-    void SharedPointer<T>::swap(SharedPointer& other)
-    {
-        // if not the same object, and not already in the same list
-        if (this != &other && obj_ptr_ != other.obj_ptr_) {
-            if (mutex_ptr_) {
-                ListLock lock(*mutex_ptr_); // lock current list during swap
-                SharedPointer tmp;
-                // tmp = *this;
-                // *this = 0;
-                std::swap(tmp.mutex_ptr_, mutex_ptr_);
-                std::swap(tmp.prev_ptr_, prev_ptr_);
-                std::swap(tmp.next_ptr_, next_ptr_);
-                std::swap(tmp.obj_ptr_, obj_ptr_);
-                std::swap(tmp.delete_func_, delete_func_);
-                if (tmp.prev_ptr_) {
-                    tmp.prev_ptr_->next_ptr_ = &tmp;
-                }
-                if (tmp.next_ptr_) {
-                    tmp.next_ptr_->prev_ptr_ = &tmp;
-                }
-                //*this = other;
-                // other = 0;
-                other.AddToList(*this, true);
-                // other = tmp;
-                // tmp = 0;
-                std::swap(tmp.mutex_ptr_, other.mutex_ptr_);
-                std::swap(tmp.prev_ptr_, other.prev_ptr_);
-                std::swap(tmp.next_ptr_, other.next_ptr_);
-                std::swap(tmp.obj_ptr_, other.obj_ptr_);
-                std::swap(tmp.delete_func_, other.delete_func_);
-                if (other.prev_ptr_) {
-                    other.prev_ptr_->next_ptr_ = &other;
-                }
-                if (other.next_ptr_) {
-                    other.next_ptr_->prev_ptr_ = &other;
-                }
-            }
-            else { // *this == 0
-                // *this = other
-                // other = 0;
-                other.AddToList(*this, true);
-                other.reset();
-            }
+    template<typename T, typename Policy>
+    template<typename U>
+    SharedPointer<T, Policy>& SharedPointer<T, Policy>::operator=(const SharedPointer<U, Policy>& other)
+    {
+        SharedPointer(other).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>& SharedPointer<T, Policy>::operator=(SharedPointer&& other) noexcept
+    {
+        SharedPointer(c11::move(other)).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    template<typename U>
+    SharedPointer<T, Policy>& SharedPointer<T, Policy>::operator=(SharedPointer<U, Policy>&& other) noexcept
+    {
+        SharedPointer(c11::move(other)).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void SharedPointer<T, Policy>::swap(SharedPointer& other) noexcept
+    {
+        std::swap(obj_ptr_, other.obj_ptr_);
+        std::swap(control_ptr_, other.control_ptr_);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void SharedPointer<T, Policy>::reset() noexcept
+    {
+        Control* control_ptr = control_ptr_;
+        obj_ptr_ = 0;
+        control_ptr_ = 0;
+        if (control_ptr) { // release after *this is empty, in case the managed object owns *this
+            control_ptr->Release();
         }
     }
 
     //-----------------
-    template<typename T>
-    void SharedPointer<T>::reset()
+    template<typename T, typename Policy>
+    template<typename U>
+    void SharedPointer<T, Policy>::reset(U* ptr)
     {
-        if (mutex_ptr_) { // if in a list
-            ListLock lock(*mutex_ptr_);
-            if (obj_ptr_ && !prev_ptr_ && !next_ptr_) {
-                if (delete_func_) {
-                    delete_func_(obj_ptr_);
-                    delete_func_ = 0;
-                }
-                else {
-                    delete obj_ptr_;
-                }
-                obj_ptr_ = 0;
-            }
-            // if necessary, update *prev_ptr_
-            if (prev_ptr_) {
-                prev_ptr_->next_ptr_ = next_ptr_;
+        Control* control_ptr = 0;
+        if (ptr) {
+            try {
+                control_ptr = new SharedControlBlock<U, Policy>(ptr, 0);
             }
-            // if necessary, update *next_ptr_
-            if (next_ptr_) {
-                next_ptr_->prev_ptr_ = prev_ptr_;
+            catch (...) {
+                delete ptr;
+                throw;
             }
-            prev_ptr_ = 0;
-            next_ptr_ = 0;
-        } // unlock mutex before deleting it
-        // if obj_ptr_ was deleted, also delete mutex_ptr_
-        if (mutex_ptr_ && !obj_ptr_) {
-            delete mutex_ptr_;
-            mutex_ptr_ = 0;
         }
+        Attach(ptr, control_ptr);
     }
 
     //-----------------
-    template<typename T>
+    template<typename T, typename Policy>
     template<typename U>
-    void SharedPointer<T>::reset(U* ptr)
+    void SharedPointer<T, Policy>::reset(U* ptr, DeleteFunction delete_func)
     {
+        Control* control_ptr = 0;
         if (ptr) {
-            reset();
-            mutex_ptr_ = new PooledMutex();
-            obj_ptr_ = ptr;
+            try {
+                control_ptr = new SharedControlBlock<T, Policy>(ptr, delete_func);
+            }
+            catch (...) {
+                if (delete_func) {
+                    delete_func(ptr);
+                }
+                else {
+                    delete ptr;
+                }
+                throw;
+            }
         }
+        Attach(ptr, control_ptr);
     }
 
     //-----------------
-    template<typename T>
-    template<typename U>
-    void SharedPointer<T>::reset(U* ptr, DeleteFunction delete_func)
+    template<typename T, typename Policy>
+    template<typename U, typename Deleter, typename>
+    void SharedPointer<T, Policy>::reset(U* ptr, Deleter deleter)
     {
+        Control* control_ptr = 0;
         if (ptr) {
-            reset();
-            mutex_ptr_ = new PooledMutex();
-            obj_ptr_ = ptr;
-            delete_func_ = delete_func;
+            try {
+                control_ptr = new SharedDeleterBlock<U, Deleter, Policy>(ptr, deleter);
+            }
+            catch (...) {
+                deleter(ptr);
+                throw;
+            }
         }
+        Attach(ptr, control_ptr);
     }
 
     //-----------------
-    template<typename T>
-    T* SharedPointer<T>::get() const
+    template<typename T, typename Policy>
+    T* SharedPointer<T, Policy>::get() const
     {
         return  obj_ptr_;
     }
 
     //-----------------
-    template<typename T>
-    T& SharedPointer<T>::operator*() const
+    template<typename T, typename Policy>
+    T& SharedPointer<T, Policy>::operator*() const
     {
         return *obj_ptr_;
     }
 
     //-----------------
-    template<typename T>
-    T* SharedPointer<T>::operator->() const
+    template<typename T, typename Policy>
+    T* SharedPointer<T, Policy>::operator->() const
     {
         return obj_ptr_;
     }
 
     //-----------------
-    template<typename T>
-    SharedPointer<T>::operator bool() const
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy>::operator bool() const
     {
         return (obj_ptr_ != 0);
     }
 
     //-----------------
-    template<typename T>
-    long int SharedPointer<T>::use_count()
+    template<typename T, typename Policy>
+    long int SharedPointer<T, Policy>::use_count() const
     {
-        long int retval = 0;
-        if (mutex_ptr_) {
-            ListLock lock(*mutex_ptr_);
-            for (SharedPointer* ptr = this; ptr != nullptr; ptr = ptr->prev_ptr_) {
-                ++retval;
-            }
-            for (SharedPointer* ptr = next_ptr_; ptr != nullptr; ptr = ptr->next_ptr_) {
-                ++retval;
-            }
-        }
-        return retval;
+        return control_ptr_ ? control_ptr_->GetUseCount() : 0;
     }
 
     //-----------------
-    template<typename T>
-    bool SharedPointer<T>::unique()
+    template<typename T, typename Policy>
+    bool SharedPointer<T, Policy>::unique() const
     {
-        bool retval = false;
-        if (mutex_ptr_) {
-            ListLock lock(*mutex_ptr_);
-            retval = (prev_ptr_ == 0 && next_ptr_ == 0);
-        }
-        return retval;
+        return (use_count() == 1);
     }
 
     //-----------------
-    template<typename T>
-    void SharedPointer<T>::AddToList(SharedPointer& other, bool replace)
+    template<typename T, typename Policy>
+    void SharedPointer<T, Policy>::Attach(T* ptr, Control* control_ptr)
     {
-        if (other.mutex_ptr_) {
-            throw std::runtime_error("argument is already in a list");
-        }
-        if (mutex_ptr_) { // if *this is in a list
-            ListLock lock(*mutex_ptr_);
-            // insert other after *this
-            other.obj_ptr_ = obj_ptr_;
-            other.delete_func_ = delete_func_;
-            other.mutex_ptr_ = mutex_ptr_;
-            other.next_ptr_ = next_ptr_;
-            other.prev_ptr_ = this;
-            next_ptr_ = &other;
-            if (replace) {
-                // while still locked, reset *this
-                if (next_ptr_) {
-                    next_ptr_->prev_ptr_ = prev_ptr_;
-                }
-                if (prev_ptr_) {
-                    prev_ptr_->next_ptr_ = next_ptr_;
-                }
-                mutex_ptr_ = 0;
-                next_ptr_ = 0;
-                prev_ptr_ = 0;
-                obj_ptr_ = 0;
-                delete_func_ = 0;
-            }
-        }
+        SharedPointer old;
+        old.swap(*this); // released when old is destroyed
+        obj_ptr_ = ptr;
+        control_ptr_ = control_ptr;
     }
 
     //-----------------
-    template<typename T>
-    const size_t SharedPointer<T>::element_size_ = sizeof(SharedPointer<T>);
+    template<typename T, typename Policy>
+    const size_t SharedPointer<T, Policy>::element_size_ = sizeof(SharedPointer<T, Policy>);
+
+    //-----------------
+    template<typename T, typename... Args>
+    SharedPointer<T> MakeShared(Args&&... args)
+    {
+        return MakeBasicShared<T, AtomicCountPolicy>(c11::forward<Args>(args)...);
+    }
+
+    //-----------------
+    template<typename T, typename... Args>
+    LocalSharedPointer<T> MakeLocalShared(Args&&... args)
+    {
+        return MakeBasicShared<T, LocalCountPolicy>(c11::forward<Args>(args)...);
+    }
+
+    //-----------------
+    template<typename T, typename Policy, typename... Args>
+    SharedPointer<T, Policy> MakeBasicShared(Args&&... args)
+    {
+        SharedObjectBlock<T, Policy>* block_ptr = new SharedObjectBlock<T, Policy>(c11::forward<Args>(args)...);
+        SharedPointer<T, Policy> retval;
+        retval.Attach(block_ptr->GetPointer(), block_ptr);
+        return retval;
+    }
 
     //-----------------
     // lhs==rhs
-    template<typename T>
-    bool operator==(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs) { return (lhs.get() == rhs.get()); }
-    // lhs==0
-    template<typename T>
-    bool operator==(nullptr_t, const SharedPointer<T>& rhs) { return (lhs.get() == nullptr); }
+    template<typename T, typename P>
+    bool operator==(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs) { return (lhs.get() == rhs.get()); }
     // 0==rhs
-    template<typename T>
-    bool operator==(const SharedPointer<T>& lhs, nullptr_t) { return (lhs.get() == nullptr); }
+    template<typename T, typename P>
+    bool operator==(nullptr_t, const SharedPointer<T, P>& rhs) { return (rhs.get() == nullptr); }
+    // lhs==0
+    template<typename T, typename P>
+    bool operator==(const SharedPointer<T, P>& lhs, nullptr_t) { return (lhs.get() == nullptr); }
 
     //-----------------
+    // lhs!=rhs
+    template<typename T, typename P>
+    bool operator!=(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs) { return (lhs.get() != rhs.get()); }
     // 0!=rhs
-    template<typename T>
-    bool operator!=(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs) { return (lhs.get() != rhs.get()); }
+    template<typename T, typename P>
+    bool operator!=(nullptr_t, const SharedPointer<T, P>& rhs) { return (rhs.get() != nullptr); }
     // lhs!=0
-    template<typename T>
-    bool operator!=(nullptr_t, const SharedPointer<T>& rhs) { return (lhs.get() != nullptr); }
-    // 0!=rhs
-    template<typename T>
-    bool operator!=(const SharedPointer<T>& lhs, nullptr_t) { return (lhs.get() != nullptr); }
+    template<typename T, typename P>
+    bool operator!=(const SharedPointer<T, P>& lhs, nullptr_t) { return (lhs.get() != nullptr); }
 
     //-----------------
     // lhs<rhs
-    template<typename T>
-    bool operator<(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs) { return (lhs.get() < rhs.get()); }
-    // lhs<0
-    template<typename T>
-    bool operator<(nullptr_t, const SharedPointer<T>& rhs) { return (lhs.get() < nullptr); }
+    template<typename T, typename P>
+    bool operator<(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs) { return (lhs.get() < rhs.get()); }
     // 0<rhs
-    template<typename T>
-    bool operator<(const SharedPointer<T>& lhs, nullptr_t) { return (lhs.get() < nullptr); }
+    template<typename T, typename P>
+    bool operator<(nullptr_t, const SharedPointer<T, P>& rhs) { return (static_cast<T*>(nullptr) < rhs.get()); }
+    // lhs<0
+    template<typename T, typename P>
+    bool operator<(const SharedPointer<T, P>& lhs, nullptr_t) { return (lhs.get() < static_cast<T*>(nullptr)); }
 
     //-----------------
     // lhs>rhs
-    template<typename T>
-    bool operator>(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs) { return (lhs.get() > rhs.get()); }
-    // lhs>0
-    template<typename T>
-    bool operator>(nullptr_t, const SharedPointer<T>& rhs) { return (lhs.get() > nullptr); }
+    template<typename T, typename P>
+    bool operator>(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs) { return (lhs.get() > rhs.get()); }
     // 0>rhs
-    template<typename T>
-    bool operator>(const SharedPointer<T>& lhs, nullptr_t) { return (lhs.get() > nullptr); }
+    template<typename T, typename P>
+    bool operator>(nullptr_t, const SharedPointer<T, P>& rhs) { return (static_cast<T*>(nullptr) > rhs.get()); }
+    // lhs>0
+    template<typename T, typename P>
+    bool operator>(const SharedPointer<T, P>& lhs, nullptr_t) { return (lhs.get() > static_cast<T*>(nullptr)); }
 
     //-----------------
     // lhs>=rhs
-    template<typename T>
-    bool operator>=(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs) { return (lhs.get() >= rhs.get()); }
-    // lhs>=0
-    template<typename T>
-    bool operator>=(nullptr_t, const SharedPointer<T>& rhs) { return (lhs.get() >= nullptr); }
+    template<typename T, typename P>
+    bool operator>=(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs) { return (lhs.get() >= rhs.get()); }
     // 0>=rhs
-    template<typename T>
-    bool operator>=(const SharedPointer<T>& lhs, nullptr_t) { return (lhs.get() >= nullptr); }
+    template<typename T, typename P>
+    bool operator>=(nullptr_t, const SharedPointer<T, P>& rhs) { return (static_cast<T*>(nullptr) >= rhs.get()); }
+    // lhs>=0
+    template<typename T, typename P>
+    bool operator>=(const SharedPointer<T, P>& lhs, nullptr_t) { return (lhs.get() >= static_cast<T*>(nullptr)); }
 
     //-----------------
     // lhs<=rhs
-    template<typename T>
-    bool operator<=(const SharedPointer<T>& lhs, const SharedPointer<T>& rhs) { return (lhs.get() <= rhs.get()); }
-    // lhs<=0
-    template<typename T>
-    bool operator<=(nullptr_t, const SharedPointer<T>& rhs) { return (lhs.get() <= nullptr); }
+    template<typename T, typename P>
+    bool operator<=(const SharedPointer<T, P>& lhs, const SharedPointer<T, P>& rhs) { return (lhs.get() <= rhs.get()); }
     // 0<=rhs
-    template<typename T>
-    bool operator<=(const SharedPointer<T>& lhs, nullptr_t) { return (lhs.get() <= nullptr); }
+    template<typename T, typename P>
+    bool operator<=(nullptr_t, const SharedPointer<T, P>& rhs) { return (static_cast<T*>(nullptr) <= rhs.get()); }
+    // lhs<=0
+    template<typename T, typename P>
+    bool operator<=(const SharedPointer<T, P>& lhs, nullptr_t) { return (lhs.get() <= static_cast<T*>(nullptr)); }
 
     //-----------------
-    template<typename charT, typename traits, typename T>
-    std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>& os, const SharedPointer<T>& rhs)
+    template<typename charT, typename traits, typename T, typename P>
+    std::basic_ostream<charT, traits>& operator<<(std::basic_ostream<charT, traits>& os, const SharedPointer<T, P>& rhs)
     {
         return (os << rhs.get());
     }
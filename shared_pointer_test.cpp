@@ -2,9 +2,33 @@
 
 #include "shared_pointer.h"
 
-#include "pooled_mutex.h"
+#include "pool_list.h"
 #include "static_pool_list.h"
 
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    int deleted_count = 0;
+
+    // object that counts its destructor calls
+    struct Counted {
+        Counted(int a, int b) : value(a + b) {}
+        ~Counted() { ++deleted_count; }
+        int value;
+    };
+
+    void CountingDelete(int* ptr)
+    {
+        ++deleted_count;
+        delete ptr;
+    }
+
+} // namespace
+
 BOOST_AUTO_TEST_SUITE(SHARED_POINTER)
 BOOST_AUTO_TEST_CASE(shared_pointer_test)
 {
@@ -166,4 +190,286 @@ BOOST_AUTO_TEST_CASE(shared_pointer_test)
         BOOST_TEST_MESSAGE("exception in shared_pointer_test: " << ex.what());
     }
 }
+
+BOOST_AUTO_TEST_CASE(shared_pointer_control_test)
+{
+    BOOST_TEST_MESSAGE("Starting shared_pointer_control_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // managed pointer and control block pointer only
+        BOOST_CHECK_EQUAL(sizeof(ldl::SharedPointer<int>), 2 * sizeof(void*));
+
+        // delete function is called once, by the last owner
+        deleted_count = 0;
+        {
+            ldl::SharedPointer<int> s1(new int(5), &CountingDelete);
+            ldl::SharedPointer<int> s2(s1);
+            BOOST_CHECK_EQUAL(s2.use_count(), 2);
+            s1.reset();
+            BOOST_CHECK_EQUAL(deleted_count, 0);
+            s2.reset(new int(6), &CountingDelete);
+            BOOST_CHECK_EQUAL(deleted_count, 1);
+        }
+        BOOST_CHECK_EQUAL(deleted_count, 2);
+
+        // comparison with nullptr
+        ldl::SharedPointer<int> s3(new int(7));
+        ldl::SharedPointer<int> s4;
+        BOOST_CHECK(s4 == nullptr);
+        BOOST_CHECK(nullptr == s4);
+        BOOST_CHECK(s3 != nullptr);
+        BOOST_CHECK(nullptr != s3);
+        BOOST_CHECK(nullptr < s3);
+        BOOST_CHECK(s3 > nullptr);
+        BOOST_CHECK(s3 != s4);
+
+        // concurrent copies and resets of the same pointer
+        const size_t num_threads = 4;
+        const size_t num_copies = 10000;
+        std::vector<std::thread> threads;
+        for (size_t ix = 0; ix < num_threads; ++ix) {
+            threads.push_back(std::thread([&s3, num_copies]() {
+                for (size_t jx = 0; jx < num_copies; ++jx) {
+                    ldl::SharedPointer<int> copy(s3);
+                    ldl::SharedPointer<int> other;
+                    other = copy;
+                }
+            }));
+        }
+        for (size_t ix = 0; ix < num_threads; ++ix) {
+            threads[ix].join();
+        }
+        BOOST_CHECK_EQUAL(s3.use_count(), 1);
+        BOOST_CHECK_EQUAL(*s3, 7);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in shared_pointer_control_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_CASE(shared_pointer_use_count_test)
+{
+    BOOST_TEST_MESSAGE("Starting shared_pointer_use_count_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // use_count() and unique() work on const objects
+        const ldl::SharedPointer<int> s1(new int(3));
+        BOOST_CHECK_EQUAL(s1.use_count(), 1);
+        BOOST_CHECK_EQUAL(s1.unique(), true);
+
+        // many owners
+        const size_t num_owners = 5000;
+        std::vector<ldl::SharedPointer<int> > owners(num_owners, s1);
+        BOOST_CHECK_EQUAL(s1.use_count(), num_owners + 1);
+        BOOST_CHECK_EQUAL(owners[num_owners / 2].use_count(), num_owners + 1);
+        BOOST_CHECK_EQUAL(s1.unique(), false);
+
+        owners.resize(num_owners / 2);
+        BOOST_CHECK_EQUAL(s1.use_count(), num_owners / 2 + 1);
+        owners.clear();
+        BOOST_CHECK_EQUAL(s1.use_count(), 1);
+        BOOST_CHECK_EQUAL(s1.unique(), true);
+
+        ldl::SharedPointer<int> s2;
+        BOOST_CHECK_EQUAL(s2.use_count(), 0);
+        BOOST_CHECK_EQUAL(s2.unique(), false);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in shared_pointer_use_count_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_CASE(make_shared_test)
+{
+    BOOST_TEST_MESSAGE("Starting make_shared_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+        const size_t block_size = sizeof(ldl::SharedObjectBlock<Counted>);
+
+        deleted_count = 0;
+        ldl::SharedPointer<Counted> s1 = ldl::MakeShared<Counted>(2, 3);
+        size_t num_free = ldl::StaticPoolList::GetPoolFree(block_size);
+        BOOST_CHECK_EQUAL(s1->value, 5);
+        BOOST_CHECK_EQUAL(s1.use_count(), 1);
+
+        // object and ownership state come from the same block
+        ldl::SharedPointer<Counted> s2 = ldl::MakeShared<Counted>(1, 1);
+        BOOST_CHECK_EQUAL(ldl::StaticPoolList::GetPoolFree(block_size), num_free - 1);
+
+        ldl::SharedPointer<Counted> s3(s2);
+        BOOST_CHECK_EQUAL(s2.use_count(), 2);
+        s2.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 0);
+        s3.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 1);
+        BOOST_CHECK_EQUAL(ldl::StaticPoolList::GetPoolFree(block_size), num_free);
+
+        s1.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 2);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in make_shared_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_CASE(shared_pointer_move_test)
+{
+    BOOST_TEST_MESSAGE("Starting shared_pointer_move_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        BOOST_CHECK(std::is_nothrow_move_constructible<ldl::SharedPointer<int> >::value);
+        BOOST_CHECK(std::is_nothrow_move_assignable<ldl::SharedPointer<int> >::value);
+
+        // move constructor
+        ldl::SharedPointer<int> s1(new int(8));
+        int* ptr = s1.get();
+        ldl::SharedPointer<int> s2(std::move(s1));
+        BOOST_CHECK_EQUAL((bool)s1, false);
+        BOOST_CHECK_EQUAL(s1.use_count(), 0);
+        BOOST_CHECK_EQUAL(s2.get(), ptr);
+        BOOST_CHECK_EQUAL(s2.use_count(), 1);
+
+        // move assignment releases the previous pointer
+        ldl::SharedPointer<int> s3(new int(9));
+        s3 = std::move(s2);
+        BOOST_CHECK_EQUAL((bool)s2, false);
+        BOOST_CHECK_EQUAL(s3.get(), ptr);
+        BOOST_CHECK_EQUAL(s3.use_count(), 1);
+
+        // vector reallocation moves elements
+        std::vector<ldl::SharedPointer<int> > owners;
+        for (size_t ix = 0; ix < 100; ++ix) {
+            owners.push_back(s3);
+        }
+        BOOST_CHECK_EQUAL(s3.use_count(), 101);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in shared_pointer_move_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_CASE(local_shared_pointer_test)
+{
+    BOOST_TEST_MESSAGE("Starting local_shared_pointer_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // same interface as SharedPointer
+        deleted_count = 0;
+        ldl::LocalSharedPointer<Counted> s1(new Counted(1, 2));
+        BOOST_CHECK_EQUAL(s1.use_count(), 1);
+        BOOST_CHECK_EQUAL(s1->value, 3);
+        {
+            ldl::LocalSharedPointer<Counted> s2(s1);
+            ldl::LocalSharedPointer<Counted> s3;
+            s3 = s2;
+            BOOST_CHECK_EQUAL(s1.use_count(), 3);
+            BOOST_CHECK(s1 == s3);
+            BOOST_CHECK_EQUAL(s3.unique(), false);
+        }
+        BOOST_CHECK_EQUAL(s1.use_count(), 1);
+        BOOST_CHECK_EQUAL(s1.unique(), true);
+        s1.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 1);
+        BOOST_CHECK(s1 == nullptr);
+
+        // MakeLocalShared allocates one block
+        ldl::LocalSharedPointer<Counted> s4 = ldl::MakeLocalShared<Counted>(4, 5);
+        BOOST_CHECK_EQUAL(s4->value, 9);
+        ldl::LocalSharedPointer<Counted> s5(std::move(s4));
+        BOOST_CHECK_EQUAL((bool)s4, false);
+        BOOST_CHECK_EQUAL(s5.use_count(), 1);
+        s5.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 2);
+
+        // the counts are plain integers
+        BOOST_CHECK_EQUAL(sizeof(ldl::LocalSharedPointer<int>), sizeof(ldl::SharedPointer<int>));
+        BOOST_CHECK((std::is_same<ldl::LocalSharedPointer<int>::policy_type, ldl::LocalCountPolicy>::value));
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in local_shared_pointer_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_CASE(shared_pointer_aliasing_test)
+{
+    BOOST_TEST_MESSAGE("Starting shared_pointer_aliasing_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // share ownership of a member
+        deleted_count = 0;
+        ldl::SharedPointer<Counted> s1(new Counted(2, 3));
+        ldl::SharedPointer<int> member(s1, &s1->value);
+        BOOST_CHECK_EQUAL(*member, 5);
+        BOOST_CHECK_EQUAL(s1.use_count(), 2);
+        BOOST_CHECK_EQUAL(member.use_count(), 2);
+        s1.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 0);
+        BOOST_CHECK_EQUAL(*member, 5);
+        member.reset();
+        BOOST_CHECK_EQUAL(deleted_count, 1);
+
+        // slices of a buffer keep the whole buffer alive
+        ldl::SharedPointer<char> buffer(new char[64], [](char* ptr) { delete[] ptr; });
+        ldl::SharedPointer<char> slice(buffer, buffer.get() + 16);
+        buffer.reset();
+        slice.get()[0] = 'x';
+        BOOST_CHECK_EQUAL(slice.use_count(), 1);
+
+        // empty owner
+        ldl::SharedPointer<int> empty;
+        int value = 1;
+        ldl::SharedPointer<int> unowned(empty, &value);
+        BOOST_CHECK_EQUAL(unowned.get(), &value);
+        BOOST_CHECK_EQUAL(unowned.use_count(), 0);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in shared_pointer_aliasing_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_CASE(shared_pointer_deleter_test)
+{
+    BOOST_TEST_MESSAGE("Starting shared_pointer_deleter_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // block is returned to the PoolList it came from
+        ldl::PoolList pool_list;
+        const size_t block_size = sizeof(Counted);
+        pool_list.IncreasePoolSize(block_size, 2);
+        deleted_count = 0;
+        {
+            Counted* ptr = new(pool_list.Pop(block_size)) Counted(1, 2);
+            ldl::SharedPointer<Counted> s1(ptr, ldl::PoolListDeleter(pool_list, block_size));
+            BOOST_CHECK_EQUAL(pool_list.GetPoolFree(block_size), 1);
+            ldl::SharedPointer<Counted> s2(s1);
+            s1.reset();
+            BOOST_CHECK_EQUAL(pool_list.GetPoolFree(block_size), 1);
+        }
+        BOOST_CHECK_EQUAL(deleted_count, 1);
+        BOOST_CHECK_EQUAL(pool_list.GetPoolFree(block_size), 2);
+
+        // deleter with state, destroyed with the ownership block
+        int calls = 0;
+        struct CountingDeleter {
+            int* calls;
+            void operator()(int* ptr) const { ++*calls; delete ptr; }
+        };
+        CountingDeleter deleter = { &calls };
+        ldl::SharedPointer<int> s3(new int(4), deleter);
+        s3.reset(new int(5), deleter);
+        BOOST_CHECK_EQUAL(calls, 1);
+        s3.reset();
+        BOOST_CHECK_EQUAL(calls, 2);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in shared_pointer_deleter_test: " << ex.what());
+    }
+}
 BOOST_AUTO_TEST_SUITE_END()
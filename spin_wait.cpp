@@ -0,0 +1,135 @@
+#include "spin_wait.h"
+
+namespace ldl {
+
+    namespace {
+
+        // default SpinWaitConfig::spin_count. (1000 pause instructions: tens of microseconds on current processors)
+        const unsigned DEFAULT_SPIN_COUNT = 1000;
+
+        // default SpinWaitConfig::yield_count
+        const unsigned DEFAULT_YIELD_COUNT = 4;
+
+        // lowest adaptive spin limit, so the limit can grow again after a run of long waits.
+        const unsigned MIN_SPIN_LIMIT = 16;
+
+        //--------------
+        // return spin_count, or 0 if spinning can't succeed on this machine.
+        unsigned EffectiveSpinCount(unsigned spin_count)
+        {
+            return (c11::thread::hardware_concurrency() == 1) ? 0 : spin_count;
+        }
+
+    } // namespace
+
+    //--------------
+    SpinWaitConfig::SpinWaitConfig()
+        : spin_count(DEFAULT_SPIN_COUNT)
+        , yield_count(DEFAULT_YIELD_COUNT)
+        , adaptive(true)
+    {
+    }
+
+    //==========================
+
+    c11::atomic<unsigned> SpinWait::spin_count_(EffectiveSpinCount(DEFAULT_SPIN_COUNT));
+    c11::atomic<unsigned> SpinWait::yield_count_(DEFAULT_YIELD_COUNT);
+    c11::atomic<bool> SpinWait::adaptive_(true);
+    c11::atomic<unsigned> SpinWait::generation_(0);
+
+    //--------------
+    void SpinWait::SetConfig(const SpinWaitConfig& config)
+    {
+        unsigned spin_count = EffectiveSpinCount(config.spin_count);
+        spin_count_.store(spin_count, c11::memory_order_relaxed);
+        yield_count_.store(config.yield_count, c11::memory_order_relaxed);
+        adaptive_.store(config.adaptive, c11::memory_order_relaxed);
+        generation_.fetch_add(1, c11::memory_order_release);
+    }
+
+    //--------------
+    SpinWaitConfig SpinWait::GetConfig()
+    {
+        SpinWaitConfig retval;
+        retval.spin_count = spin_count_.load(c11::memory_order_relaxed);
+        retval.yield_count = yield_count_.load(c11::memory_order_relaxed);
+        retval.adaptive = adaptive_.load(c11::memory_order_relaxed);
+        return retval;
+    }
+
+    //--------------
+    unsigned SpinWait::GetSpinLimit()
+    {
+        return GetThreadSpinLimit().Get();
+    }
+
+    //--------------
+    SpinLimit& SpinWait::GetThreadSpinLimit()
+    {
+        static thread_local SpinLimit limit;
+        return limit;
+    }
+
+    //==========================
+
+    //--------------
+    SpinLimit::SpinLimit()
+        : limit_(SpinWait::spin_count_.load(c11::memory_order_relaxed))
+        , generation_(SpinWait::generation_.load(c11::memory_order_acquire))
+    {
+    }
+
+    //--------------
+    unsigned SpinLimit::Get()
+    {
+        if (!SpinWait::adaptive_.load(c11::memory_order_relaxed)) {
+            return SpinWait::spin_count_.load(c11::memory_order_relaxed);
+        }
+        Refresh();
+        return limit_;
+    }
+
+    //--------------
+    void SpinLimit::RecordSuccess(unsigned spins)
+    {
+        if (!SpinWait::adaptive_.load(c11::memory_order_relaxed)) {
+            return;
+        }
+        Refresh();
+        // move the limit 1/8 of the way towards twice the spins needed.
+        unsigned spin_count = SpinWait::spin_count_.load(c11::memory_order_relaxed);
+        int limit = static_cast<int>(limit_);
+        int target = static_cast<int>(spins < spin_count / 2 ? spins * 2 : spin_count);
+        limit += (target - limit) / 8;
+        if (limit < static_cast<int>(MIN_SPIN_LIMIT)) {
+            limit = static_cast<int>(spin_count < MIN_SPIN_LIMIT ? spin_count : MIN_SPIN_LIMIT);
+        }
+        limit_ = static_cast<unsigned>(limit);
+    }
+
+    //--------------
+    void SpinLimit::RecordFailure()
+    {
+        if (!SpinWait::adaptive_.load(c11::memory_order_relaxed)) {
+            return;
+        }
+        Refresh();
+        // spinning was wasted, so spin less next time.
+        unsigned spin_count = SpinWait::spin_count_.load(c11::memory_order_relaxed);
+        limit_ -= limit_ / 8;
+        if (limit_ < MIN_SPIN_LIMIT) {
+            limit_ = (spin_count < MIN_SPIN_LIMIT) ? spin_count : MIN_SPIN_LIMIT;
+        }
+    }
+
+    //--------------
+    void SpinLimit::Refresh()
+    {
+        unsigned generation = SpinWait::generation_.load(c11::memory_order_acquire);
+        if (generation != generation_) {
+            generation_ = generation;
+            limit_ = SpinWait::spin_count_.load(c11::memory_order_relaxed);
+        }
+    }
+
+} //namespace ldl
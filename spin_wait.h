@@ -0,0 +1,164 @@
+#pragma once
+#ifndef LDL_SPIN_WAIT_H_
+#define LDL_SPIN_WAIT_H_
+
+#include <atomic>
+#include <thread>
+namespace c11 {
+    using namespace std;
+}
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h> // _mm_pause
+#endif
+
+namespace ldl {
+
+    //-------------
+    /// Settings of the spin phase of SpinWait.
+    struct SpinWaitConfig {
+        // maximum number of pause instructions before yielding. (0 disables spinning)
+        unsigned spin_count;
+
+        // number of times to yield the processor after spinning, before giving up.
+        unsigned yield_count;
+
+        // if true, the spin limit adapts to how long recent waits took. (see SpinWait)
+        bool adaptive;
+
+        SpinWaitConfig();
+    };
+
+    //-------------
+    /// Adaptive spin limit of one waiter. (see SpinWait)
+    /// Each limit is used by a single thread, so waiters never contend on it, and waits of different kinds
+    /// (e.g. an idle thread pool worker and a Future::wait()) don't skew each other's limit.
+    class SpinLimit {
+    public:
+        SpinLimit();
+
+        // return the current spin limit. (spin_count unless adaptive)
+        unsigned Get();
+
+        // update the limit after a wait that succeeded after spins pause instructions.
+        void RecordSuccess(unsigned spins);
+
+        // update the limit after a wait that had to block.
+        void RecordFailure();
+
+    private:
+        // restart from spin_count if the settings changed since the limit was last updated.
+        void Refresh();
+
+        //---
+
+        // current limit
+        unsigned limit_;
+
+        // value of SpinWait::generation_ that limit_ belongs to
+        unsigned generation_;
+    };
+
+    //-------------
+    /// Spin phase for blocking waits that are usually satisfied within a few microseconds.
+    /// SpinUntil() checks a condition while executing pause instructions, then while yielding the processor,
+    /// and gives up so the caller can block in the kernel. Used by Future::wait(), wait_for() and wait_until().
+    ///
+    /// When adaptive, the spin limit follows the number of spins that recent successful waits needed (twice their
+    /// moving average, up to spin_count), and shrinks when waits fail, so long waits stop burning CPU.
+    /// Each thread has its own limit, and a call site with a distinct wait pattern can pass a SpinLimit of its own.
+    class SpinWait {
+    public:
+
+        // replace the settings. (spin_count is forced to 0 on a single processor, where spinning can't succeed)
+        static void SetConfig(const SpinWaitConfig& config);
+
+        // return the settings.
+        static SpinWaitConfig GetConfig();
+
+        // return the current spin limit of the calling thread. (spin_count unless adaptive)
+        static unsigned GetSpinLimit();
+
+        // return the spin limit used by the calling thread when SpinUntil() isn't given one.
+        static SpinLimit& GetThreadSpinLimit();
+
+        // tell the processor that the thread is spinning.
+        static void Pause();
+
+        // check ready() until it returns true or the spin and yield phases are over.
+        // Returns the last value returned by ready().
+        template<typename Predicate>
+        static bool SpinUntil(Predicate ready);
+
+        // same as above, with limit adapting to the waits of the caller instead of the thread's limit.
+        template<typename Predicate>
+        static bool SpinUntil(SpinLimit& limit, Predicate ready);
+
+    private:
+        friend class SpinLimit;
+
+        // SpinWaitConfig::spin_count
+        static c11::atomic<unsigned> spin_count_;
+
+        // SpinWaitConfig::yield_count
+        static c11::atomic<unsigned> yield_count_;
+
+        // SpinWaitConfig::adaptive
+        static c11::atomic<bool> adaptive_;
+
+        // incremented by SetConfig(), so every SpinLimit restarts from the new spin_count
+        static c11::atomic<unsigned> generation_;
+    };
+
+    //-----------------
+    inline void SpinWait::Pause()
+    {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+        _mm_pause();
+#elif defined(_MSC_VER) && (defined(_M_ARM) || defined(_M_ARM64))
+        __yield();
+#elif defined(__i386__) || defined(__x86_64__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+    //-----------------
+    template<typename Predicate>
+    bool SpinWait::SpinUntil(Predicate ready)
+    {
+        return SpinUntil(GetThreadSpinLimit(), ready);
+    }
+
+    //-----------------
+    template<typename Predicate>
+    bool SpinWait::SpinUntil(SpinLimit& limit, Predicate ready)
+    {
+        unsigned max_spins = limit.Get();
+        for (unsigned spins = 0; spins < max_spins; ++spins) {
+            if (ready()) {
+                limit.RecordSuccess(spins);
+                return true;
+            }
+            Pause();
+        }
+        unsigned yield_count = yield_count_.load(c11::memory_order_relaxed);
+        for (unsigned yields = 0; yields < yield_count; ++yields) {
+            if (ready()) {
+                limit.RecordSuccess(max_spins);
+                return true;
+            }
+            c11::this_thread::yield();
+        }
+        if (ready()) {
+            limit.RecordSuccess(max_spins);
+            return true;
+        }
+        limit.RecordFailure();
+        return false;
+    }
+
+} //namespace ldl
+
+#endif //! LDL_SPIN_WAIT_H_
@@ -0,0 +1,93 @@
+#include "boost/test/unit_test.hpp"
+
+#include "spin_wait.h"
+
+#include <atomic>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(SPIN_WAIT)
+
+BOOST_AUTO_TEST_CASE(spin_wait_test)
+{
+    BOOST_TEST_MESSAGE("Starting spin_wait_test");
+
+    try {
+        ldl::SpinWaitConfig saved = ldl::SpinWait::GetConfig();
+
+        // fixed limit
+        ldl::SpinWaitConfig config;
+        config.spin_count = 100;
+        config.yield_count = 2;
+        config.adaptive = false;
+        ldl::SpinWait::SetConfig(config);
+        bool single_cpu = (std::thread::hardware_concurrency() == 1);
+        BOOST_CHECK_EQUAL(ldl::SpinWait::GetSpinLimit(), single_cpu ? 0u : 100u);
+
+        int calls = 0;
+        BOOST_CHECK_EQUAL(ldl::SpinWait::SpinUntil([&calls] { return ++calls == 3; }), true);
+        BOOST_CHECK_EQUAL(calls, 3);
+
+        calls = 0;
+        BOOST_CHECK_EQUAL(ldl::SpinWait::SpinUntil([&calls] { ++calls; return false; }), false);
+        BOOST_CHECK_EQUAL(calls, static_cast<int>(ldl::SpinWait::GetSpinLimit()) + 3);
+
+        // adaptive limit shrinks after failures, and grows back after successes
+        config.spin_count = 1000;
+        config.adaptive = true;
+        ldl::SpinWait::SetConfig(config);
+        if (!single_cpu) {
+            for (int ix = 0; ix < 50; ++ix) {
+                ldl::SpinWait::SpinUntil([] { return false; });
+            }
+            unsigned low = ldl::SpinWait::GetSpinLimit();
+            BOOST_CHECK(low < 100u);
+            // waits that succeed just after the spin phase
+            for (int ix = 0; ix < 50; ++ix) {
+                int limit = static_cast<int>(ldl::SpinWait::GetSpinLimit());
+                calls = 0;
+                ldl::SpinWait::SpinUntil([&calls, limit] { return ++calls > limit; });
+            }
+            BOOST_CHECK(ldl::SpinWait::GetSpinLimit() > low);
+
+            // a separate limit adapts on its own, and doesn't affect the thread's limit
+            unsigned thread_limit = ldl::SpinWait::GetSpinLimit();
+            ldl::SpinLimit limit;
+            BOOST_CHECK_EQUAL(limit.Get(), 1000u);
+            for (int ix = 0; ix < 50; ++ix) {
+                ldl::SpinWait::SpinUntil(limit, [] { return false; });
+            }
+            BOOST_CHECK(limit.Get() < 100u);
+            BOOST_CHECK_EQUAL(ldl::SpinWait::GetSpinLimit(), thread_limit);
+
+            // new settings restart every limit from spin_count
+            ldl::SpinWait::SetConfig(config);
+            BOOST_CHECK_EQUAL(limit.Get(), 1000u);
+            BOOST_CHECK_EQUAL(ldl::SpinWait::GetSpinLimit(), 1000u);
+
+            // each thread has its own limit
+            unsigned other_limit = 0;
+            std::thread other([&other_limit]() {
+                for (int ix = 0; ix < 50; ++ix) {
+                    ldl::SpinWait::SpinUntil([] { return false; });
+                }
+                other_limit = ldl::SpinWait::GetSpinLimit();
+            });
+            other.join();
+            BOOST_CHECK(other_limit < 100u);
+            BOOST_CHECK_EQUAL(ldl::SpinWait::GetSpinLimit(), 1000u);
+        }
+
+        // condition set by another thread
+        std::atomic<bool> flag(false);
+        std::thread thread([&flag]() { flag.store(true); });
+        while (!ldl::SpinWait::SpinUntil([&flag] { return flag.load(); })) {
+        }
+        thread.join();
+
+        ldl::SpinWait::SetConfig(saved);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in spin_wait_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
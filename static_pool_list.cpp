@@ -1,96 +1,181 @@
 #include "static_pool_list.h"
 
+#include "lock_profile.h"
+#include "heap_sampler.h"
+#include "allocation_trace.h"
+
 #include <mutex> // lock_guard
 namespace c11 {
     using namespace std;
 }
 
+#ifdef LDL_LOCK_PROFILING
+#include <map>
+#include <sstream>
+#endif
+
 namespace ldl {
 
+#ifdef LDL_LOCK_PROFILING
+    namespace {
+
+        //--------------
+        // profile of all acquisitions of StaticPoolList::mutex_
+        LockProfile& DirectoryLockProfile()
+        {
+            static LockProfile& profile = LockProfile::Get("StaticPoolList");
+            return profile;
+        }
+
+        //--------------
+        // profile of the acquisitions of StaticPoolList::mutex_ made to access pool_list[block_size].
+        // Must be called while holding StaticPoolList::mutex_, which also protects the cache.
+        LockProfile& PoolLockProfile(size_t block_size)
+        {
+            static std::map<size_t, LockProfile*> profiles;
+            LockProfile*& retval = profiles[block_size];
+            if (!retval) {
+                std::ostringstream site;
+                site << "StaticPoolList[" << block_size << "]";
+                retval = &LockProfile::Get(site.str());
+            }
+            return *retval;
+        }
+
+    } // namespace
+#endif
+
     //--------------
     void StaticPoolList::Reset()
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
         pool_list_.Reset();
     }
 
     //--------------
     bool StaticPoolList::HasPool(size_t block_size)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
         return pool_list_.HasPool(block_size);
     }
 
     //--------------
     Pool& StaticPoolList::GetPool(size_t block_size)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+        LDL_LOCK_ATTRIBUTE(lock, PoolLockProfile(block_size));
         return pool_list_.GetPool(block_size);
     }
 
     //--------------
     void StaticPoolList::IncreasePoolSize(size_t block_size, size_t num_blocks)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+        LDL_LOCK_ATTRIBUTE(lock, PoolLockProfile(block_size));
         pool_list_.IncreasePoolSize(block_size, num_blocks);
     }
 
     //--------------
     void StaticPoolList::SetPoolGrowthStep(size_t block_size, int growth_step)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
         pool_list_.SetPoolGrowthStep(block_size, growth_step);
     }
 
     //--------------
     int StaticPoolList::GetPoolGrowthStep(size_t block_size)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
         return pool_list_.GetPoolGrowthStep(block_size);
     }
 
     //--------------
     size_t StaticPoolList::GetPoolFree(size_t block_size)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
         return pool_list_.GetPoolFree(block_size);
     }
 
     //--------------
     size_t StaticPoolList::GetPoolSize(size_t block_size)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
         return pool_list_.GetPoolSize(block_size);
     }
 
     //--------------
     bool StaticPoolList::PoolIsEmpty(size_t block_size)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
         return pool_list_.PoolIsEmpty(block_size);
     }
 
     //--------------
     size_t StaticPoolList::GetMaxPoolBlockSize()
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
         return pool_list_.GetMaxPoolBlockSize();
     }
 
     //--------------
     void* StaticPoolList::Pop(size_t block_size)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
-        return pool_list_.Pop(block_size);
+        void* retval = 0;
+        {
+            LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+            LDL_LOCK_ATTRIBUTE(lock, PoolLockProfile(block_size));
+            retval = pool_list_.Pop(block_size);
+        } // unlock before sampling
+        HeapSampler::RecordPop(block_size, retval);
+        AllocationTrace::RecordPop(block_size, retval);
+        return retval;
     }
 
     //--------------
     void StaticPoolList::Push(size_t block_size, void* ptr)
     {
-        c11::lock_guard<c11::mutex> lock(mutex_);
+        HeapSampler::RecordPush(ptr);
+        AllocationTrace::RecordPush(block_size, ptr);
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+        LDL_LOCK_ATTRIBUTE(lock, PoolLockProfile(block_size));
         pool_list_.Push(block_size, ptr);
     }
 
+    //--------------
+    bool StaticPoolList::SetPoolRealTime(size_t block_size, bool real_time, bool lock_memory)
+    {
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+        return pool_list_.SetPoolRealTime(block_size, real_time, lock_memory);
+    }
+
+    //--------------
+    bool StaticPoolList::GetPoolRealTime(size_t block_size)
+    {
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+        return pool_list_.GetPoolRealTime(block_size);
+    }
+
+    //--------------
+    size_t StaticPoolList::GetPoolMissCount(size_t block_size)
+    {
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+        return pool_list_.GetPoolMissCount(block_size);
+    }
+
+    //--------------
+    PoolStats StaticPoolList::GetPoolStats(size_t block_size)
+    {
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+        return pool_list_.GetPoolStats(block_size);
+    }
+
+    //--------------
+    void StaticPoolList::GetStats(std::vector<PoolStats>& stats)
+    {
+        LDL_LOCK_GUARD(lock, c11::mutex, mutex_, DirectoryLockProfile());
+        pool_list_.GetStats(stats);
+    }
+
     //--------------
     c11::mutex StaticPoolList::mutex_;
 
@@ -57,6 +57,25 @@ namespace ldl {
         // push a block onto pool_list[block_size]
         static void Push(size_t block_size, void* ptr);
 
+        // Enable or disable real-time mode for pool_list[block_size]. (see PoolList::SetPoolRealTime())
+        // Using block_size = 0 enforces real-time mode for all current and future pools.
+        static bool SetPoolRealTime(size_t block_size, bool real_time, bool lock_memory = false);
+
+        // Return true if pool_list[block_size] is in real-time mode.
+        // setting block_size=0 returns true if real-time mode is enabled for all pools.
+        static bool GetPoolRealTime(size_t block_size);
+
+        // Return the number of Pop() and Push() calls on pool_list[block_size] that had to grow the pool,
+        // or would have if growth was allowed. setting block_size=0 returns the total for all pools.
+        static size_t GetPoolMissCount(size_t block_size);
+
+        // return a snapshot of the statistics counters of pool_list[block_size].
+        // (The counters of a Pool& returned by GetPool() can also be read without locking, see Pool::GetStats().)
+        static PoolStats GetPoolStats(size_t block_size);
+
+        // replace the contents of stats with a consistent snapshot of every pool, in order of block_size.
+        static void GetStats(std::vector<PoolStats>& stats);
+
     private:
 
         static c11::mutex mutex_;
@@ -147,6 +147,19 @@ BOOST_AUTO_TEST_CASE(static_pool_list_test)
         BOOST_CHECK_EQUAL(cp30.GetFree(), 10);
         BOOST_CHECK_EQUAL(cp30.IsEmpty(), false);
         BOOST_CHECK_EQUAL(cp30.GetBlockSize(), 30);
+
+        ldl::PoolStats stats_30 = static_pool.GetPoolStats(30);
+        BOOST_CHECK_EQUAL(stats_30.block_size, 30);
+        BOOST_CHECK_EQUAL(stats_30.num_blocks, 11);
+        BOOST_CHECK_EQUAL(stats_30.in_use, 1);
+        BOOST_CHECK_EQUAL(stats_30.growth_events, 1);
+
+        std::vector<ldl::PoolStats> stats;
+        static_pool.GetStats(stats);
+        BOOST_CHECK_EQUAL(stats.size(), 3);
+        BOOST_CHECK_EQUAL(stats[0].block_size, 1);
+        BOOST_CHECK_EQUAL(stats[1].block_size, 10);
+        BOOST_CHECK_EQUAL(stats[2].block_size, 30);
     }
     catch (const std::exception& ex) {
         BOOST_TEST_MESSAGE("exception in static_pool_list_test: " << ex.what());
@@ -0,0 +1,202 @@
+#include "thread_pool.h"
+
+namespace ldl {
+
+    namespace {
+
+        // pool and index of the worker running on this thread (0 if this isn't a worker)
+        thread_local const ThreadPool* current_pool = 0;
+        thread_local size_t current_index = 0;
+
+    } // namespace
+
+    //--------------
+    ThreadPool::Worker::Worker()
+        : inbox(0)
+        , random(0)
+    {
+    }
+
+    //==========================
+
+    //--------------
+    ThreadPool::ThreadPool(size_t num_threads)
+        : next_inbox_(0)
+        , wake_epoch_(0)
+        , num_parked_(0)
+        , stop_(false)
+        , steal_count_(0)
+    {
+        if (num_threads == 0) {
+            num_threads = c11::thread::hardware_concurrency();
+            if (num_threads == 0) {
+                num_threads = 1;
+            }
+        }
+        for (size_t ix = 0; ix < num_threads; ++ix) {
+            workers_.push_back(new Worker());
+            workers_[ix]->random = static_cast<unsigned>(ix * 2654435761u + 1);
+        }
+        // start the threads after all workers exist, since they steal from each other.
+        for (size_t ix = 0; ix < num_threads; ++ix) {
+            workers_[ix]->thread = c11::thread(&ThreadPool::Run, this, ix);
+        }
+    }
+
+    //--------------
+    ThreadPool::~ThreadPool()
+    {
+        stop_.store(true);
+        wake_epoch_.fetch_add(1);
+        Futex::WakeAll(wake_epoch_);
+        for (size_t ix = 0; ix < workers_.size(); ++ix) {
+            workers_[ix]->thread.join();
+        }
+        for (size_t ix = 0; ix < workers_.size(); ++ix) {
+            delete workers_[ix];
+        }
+    }
+
+    //--------------
+    void ThreadPool::Execute(ExecutorTask* task)
+    {
+        if (current_pool == this) {
+            workers_[current_index]->deque.Push(task);
+        }
+        else {
+            Worker& worker = *workers_[next_inbox_.fetch_add(1, c11::memory_order_relaxed) % workers_.size()];
+            ExecutorTask* head = worker.inbox.load(c11::memory_order_relaxed);
+            do {
+                task->next_task_ = head;
+            } while (!worker.inbox.compare_exchange_weak(head, task, c11::memory_order_release, c11::memory_order_relaxed));
+        }
+        WakeWorker();
+    }
+
+    //--------------
+    size_t ThreadPool::GetThreadCount() const
+    {
+        return workers_.size();
+    }
+
+    //--------------
+    size_t ThreadPool::GetStealCount() const
+    {
+        return steal_count_.load(c11::memory_order_relaxed);
+    }
+
+    //--------------
+    void ThreadPool::Run(size_t index)
+    {
+        current_pool = this;
+        current_index = index;
+        while (true) {
+            ExecutorTask* task = FindTask(index);
+            if (task) {
+                task->Run();
+                continue;
+            }
+            // spin briefly in case more work arrives, then park.
+            if (SpinWait::SpinUntil(workers_[index]->spin_limit, [this] { return HasWork() || stop_.load(c11::memory_order_relaxed); })) {
+                if (!HasWork()) { // stop_ and nothing left to run
+                    break;
+                }
+                continue;
+            }
+            c11::uint32_t epoch = wake_epoch_.load(c11::memory_order_acquire);
+            num_parked_.fetch_add(1, c11::memory_order_seq_cst);
+            // order the increment before the loads of HasWork(), which are relaxed. (pairs with the fence in WakeWorker())
+            c11::atomic_thread_fence(c11::memory_order_seq_cst);
+            // check again after announcing that we are parking, so a task queued meanwhile isn't missed.
+            if (!HasWork() && !stop_.load(c11::memory_order_seq_cst)) {
+                Futex::Wait(wake_epoch_, epoch);
+            }
+            num_parked_.fetch_sub(1, c11::memory_order_relaxed);
+        }
+        current_pool = 0;
+    }
+
+    //--------------
+    ExecutorTask* ThreadPool::FindTask(size_t index)
+    {
+        Worker& worker = *workers_[index];
+        ExecutorTask* task = worker.deque.Take();
+        if (task) {
+            return task;
+        }
+        if (DrainInbox(worker, worker)) {
+            task = worker.deque.Take();
+            if (task) {
+                return task;
+            }
+        }
+        // steal, starting from a random victim
+        size_t num_workers = workers_.size();
+        worker.random = worker.random * 1103515245u + 12345u;
+        size_t start = (worker.random >> 16) % num_workers;
+        for (size_t ix = 0; ix < num_workers; ++ix) {
+            size_t victim = (start + ix) % num_workers;
+            if (victim == index) {
+                continue;
+            }
+            task = workers_[victim]->deque.Steal();
+            if (!task && DrainInbox(*workers_[victim], worker)) {
+                // the victim hasn't picked up its inbox (it may be parked or busy)
+                task = worker.deque.Take();
+            }
+            if (task) {
+                steal_count_.fetch_add(1, c11::memory_order_relaxed);
+                return task;
+            }
+        }
+        return 0;
+    }
+
+    //--------------
+    bool ThreadPool::DrainInbox(Worker& from, Worker& to)
+    {
+        if (from.inbox.load(c11::memory_order_relaxed) == 0) {
+            return false;
+        }
+        ExecutorTask* stack = from.inbox.exchange(0, c11::memory_order_acquire);
+        // reverse the stack, so tasks are pushed in the order they were submitted.
+        ExecutorTask* queue = 0;
+        while (stack) {
+            ExecutorTask* next = stack->next_task_;
+            stack->next_task_ = queue;
+            queue = stack;
+            stack = next;
+        }
+        bool retval = (queue != 0);
+        while (queue) {
+            ExecutorTask* next = queue->next_task_;
+            queue->next_task_ = 0;
+            to.deque.Push(queue);
+            queue = next;
+        }
+        return retval;
+    }
+
+    //--------------
+    bool ThreadPool::HasWork() const
+    {
+        for (size_t ix = 0; ix < workers_.size(); ++ix) {
+            if (!workers_[ix]->deque.IsEmpty() || workers_[ix]->inbox.load(c11::memory_order_relaxed) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //--------------
+    void ThreadPool::WakeWorker()
+    {
+        // order the push of the task before the load of num_parked_. (pairs with the fence in Run())
+        c11::atomic_thread_fence(c11::memory_order_seq_cst);
+        if (num_parked_.load(c11::memory_order_relaxed) > 0) {
+            wake_epoch_.fetch_add(1, c11::memory_order_release);
+            Futex::WakeOne(wake_epoch_);
+        }
+    }
+
+} //namespace ldl
@@ -0,0 +1,155 @@
+#pragma once
+#ifndef LDL_THREAD_POOL_H_
+#define LDL_THREAD_POOL_H_
+
+#include "pooled_new.h"
+#include "executor.h"
+#include "future.h"
+#include "futex.h"
+#include "spin_wait.h"
+#include "work_stealing_deque.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <type_traits> // decay
+#include <utility> // declval
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Type of the value returned by calling Fn with no arguments. (see ThreadPool::Submit())
+    template<typename Fn>
+    struct SubmitResult {
+        typedef typename c11::decay<decltype(c11::declval<Fn&>()())>::type type;
+    };
+
+    //-------------
+    /// Pooled task created by ThreadPool::Submit(): sets the value of a Promise to fn().
+    template<typename Fn, typename R>
+    class SubmitTask : public ExecutorTask {
+    public:
+
+        // constructor
+        explicit SubmitTask(const Fn& fn);
+
+        // return the Future for the result.
+        Future<R> GetFuture();
+
+        // call fn_, set the value of promise_, and delete this.
+        virtual void Run();
+
+    private:
+
+        // function to call
+        Fn fn_;
+
+        // promise for the result of fn_ (or the exception it throws)
+        Promise<R> promise_;
+
+        //---
+
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+    };
+
+    //-------------
+    /// Fixed-size pool of worker threads that run ExecutorTask objects.
+    /// Each worker has a Chase-Lev deque, which it uses as a stack for the tasks it creates, and which idle
+    /// workers steal from, plus a lock-free inbox for tasks submitted by other threads. There is no central queue
+    /// or lock. Idle workers park on a futex word, and are only woken when a task is queued while some are parked.
+    class ThreadPool : public Executor {
+    public:
+
+        // constructor. Starts num_threads workers. (0: one per processor)
+        explicit ThreadPool(size_t num_threads = 0);
+
+        // destructor. Runs the tasks that are still queued, then stops the workers.
+        virtual ~ThreadPool();
+
+        // queue task. Called by a worker of this pool, the task is pushed onto the worker's own deque.
+        // Otherwise it is pushed onto the inbox of one of the workers, in turn.
+        virtual void Execute(ExecutorTask* task);
+
+        // run fn() on a worker, and return a Future for its result, or the exception it throws.
+        // The task is allocated from a Pool.
+        template<typename Fn>
+        Future<typename SubmitResult<Fn>::type> Submit(Fn fn);
+
+        // return the number of worker threads.
+        size_t GetThreadCount() const;
+
+        // return the number of tasks that were stolen from another worker.
+        size_t GetStealCount() const;
+
+    private:
+
+        //-------------
+        // state of one worker thread
+        struct Worker {
+            Worker();
+
+            // tasks created by this worker
+            WorkStealingDeque deque;
+
+            // stack of tasks submitted by other threads
+            c11::atomic<ExecutorTask*> inbox;
+
+            // state of the random victim selection
+            unsigned random;
+
+            // adaptive spin limit of the worker's idle waits, kept apart from the limit of its Future waits.
+            SpinLimit spin_limit;
+
+            c11::thread thread;
+        };
+
+        // body of worker thread index.
+        void Run(size_t index);
+
+        // return a task for worker index to run, or 0 if there isn't any.
+        ExecutorTask* FindTask(size_t index);
+
+        // move the tasks in the inbox of from to the deque of to, which must belong to the calling thread.
+        // Returns false if the inbox was empty.
+        bool DrainInbox(Worker& from, Worker& to);
+
+        // return true if any worker has queued tasks.
+        bool HasWork() const;
+
+        // wake a parked worker, if there is one.
+        void WakeWorker();
+
+        //---
+
+        // workers
+        std::vector<Worker*> workers_;
+
+        // next inbox to use for a task submitted from outside the pool
+        c11::atomic<size_t> next_inbox_;
+
+        // incremented to wake parked workers
+        Futex::Word wake_epoch_;
+
+        // number of workers that are parked, or about to park
+        c11::atomic<int> num_parked_;
+
+        // true when the workers have been asked to exit
+        c11::atomic<bool> stop_;
+
+        // number of tasks stolen
+        c11::atomic<size_t> steal_count_;
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+    };
+
+} //namespace ldl
+
+#include "thread_pool.hpp"
+
+#endif //! LDL_THREAD_POOL_H_
@@ -0,0 +1,49 @@
+#include "thread_pool.h"
+
+namespace ldl {
+
+    //---------------
+    template<typename Fn, typename R>
+    SubmitTask<Fn, R>::SubmitTask(const Fn& fn)
+        : fn_(fn)
+    {
+    }
+
+    //---------------
+    template<typename Fn, typename R>
+    Future<R> SubmitTask<Fn, R>::GetFuture()
+    {
+        return promise_.get_future();
+    }
+
+    //---------------
+    template<typename Fn, typename R>
+    void SubmitTask<Fn, R>::Run()
+    {
+        try {
+            promise_.set_value(FutureValue<R>::Call(fn_));
+        }
+        catch (...) {
+            promise_.set_exception(c11::current_exception());
+        }
+        delete this;
+    }
+
+    //---------------
+    template<typename Fn, typename R>
+    const size_t SubmitTask<Fn, R>::element_size_ = sizeof(SubmitTask<Fn, R>);
+
+    //==========================
+
+    //---------------
+    template<typename Fn>
+    Future<typename SubmitResult<Fn>::type> ThreadPool::Submit(Fn fn)
+    {
+        typedef typename SubmitResult<Fn>::type R;
+        SubmitTask<Fn, R>* task = new SubmitTask<Fn, R>(fn);
+        Future<R> retval = task->GetFuture();
+        Execute(task);
+        return retval;
+    }
+
+} //namespace ldl
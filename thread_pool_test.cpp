@@ -0,0 +1,177 @@
+#include "boost/test/unit_test.hpp"
+
+#include "thread_pool.h"
+#include "work_stealing_deque.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(THREAD_POOL)
+
+namespace {
+
+    // task that increments a counter
+    struct CountTask : public ldl::ExecutorTask {
+        CountTask() : count(0) {}
+        virtual void Run() { count.fetch_add(1); }
+        c11::atomic<int> count;
+    };
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(work_stealing_deque_test)
+{
+    BOOST_TEST_MESSAGE("Starting work_stealing_deque_test");
+
+    try {
+        // owner takes in LIFO order, thieves steal in FIFO order, and the deque grows past its capacity
+        std::vector<CountTask> tasks(10);
+        ldl::WorkStealingDeque deque(4);
+        BOOST_CHECK(deque.IsEmpty());
+        BOOST_CHECK(deque.Take() == 0);
+        BOOST_CHECK(deque.Steal() == 0);
+        for (size_t ix = 0; ix < tasks.size(); ++ix) {
+            deque.Push(&tasks[ix]);
+        }
+        BOOST_CHECK(!deque.IsEmpty());
+        BOOST_CHECK(deque.Take() == &tasks[9]);
+        BOOST_CHECK(deque.Steal() == &tasks[0]);
+        BOOST_CHECK(deque.Steal() == &tasks[1]);
+        BOOST_CHECK(deque.Take() == &tasks[8]);
+        size_t remaining = 0;
+        while (deque.Take()) {
+            ++remaining;
+        }
+        BOOST_CHECK_EQUAL(remaining, 6u);
+        BOOST_CHECK(deque.IsEmpty());
+
+        // every task is returned exactly once while the owner and thieves race
+        const int NUM_TASKS = 20000;
+        std::vector<CountTask> race_tasks(NUM_TASKS);
+        ldl::WorkStealingDeque race_deque;
+        c11::atomic<bool> done(false);
+        std::vector<c11::thread> thieves;
+        for (int ix = 0; ix < 3; ++ix) {
+            thieves.push_back(c11::thread([&]() {
+                while (!done.load()) {
+                    ldl::ExecutorTask* task = race_deque.Steal();
+                    if (task) {
+                        task->Run();
+                    }
+                }
+            }));
+        }
+        for (int ix = 0; ix < NUM_TASKS; ++ix) {
+            race_deque.Push(&race_tasks[ix]);
+            if (ix % 3 == 0) {
+                ldl::ExecutorTask* task = race_deque.Take();
+                if (task) {
+                    task->Run();
+                }
+            }
+        }
+        while (ldl::ExecutorTask* task = race_deque.Take()) {
+            task->Run();
+        }
+        done.store(true);
+        for (size_t ix = 0; ix < thieves.size(); ++ix) {
+            thieves[ix].join();
+        }
+        int wrong = 0;
+        for (int ix = 0; ix < NUM_TASKS; ++ix) {
+            if (race_tasks[ix].count.load() != 1) {
+                ++wrong;
+            }
+        }
+        BOOST_CHECK_EQUAL(wrong, 0);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in work_stealing_deque_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_test)
+{
+    BOOST_TEST_MESSAGE("Starting thread_pool_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        ldl::ThreadPool pool(4);
+        BOOST_CHECK_EQUAL(pool.GetThreadCount(), 4u);
+
+        // Submit returns the result through a Future
+        ldl::Future<c11::thread::id> fut = pool.Submit([]() { return c11::this_thread::get_id(); });
+        BOOST_CHECK(fut.get() != c11::this_thread::get_id());
+
+        // many tasks from outside the pool
+        c11::atomic<int> count(0);
+        std::vector<ldl::Future<int>> futures;
+        for (int ix = 0; ix < 1000; ++ix) {
+            futures.push_back(pool.Submit([&count, ix]() { count.fetch_add(1); return ix; }));
+        }
+        int sum = 0;
+        for (size_t ix = 0; ix < futures.size(); ++ix) {
+            sum += futures[ix].get();
+        }
+        BOOST_CHECK_EQUAL(sum, 999 * 1000 / 2);
+        BOOST_CHECK_EQUAL(count.load(), 1000);
+
+        // tasks submitted by a task go to the worker's own deque, and idle workers steal them
+        c11::atomic<int> nested(0);
+        ldl::Future<int> outer = pool.Submit([&pool, &nested]() {
+            for (int ix = 0; ix < 200; ++ix) {
+                pool.Submit([&nested]() { nested.fetch_add(1); return 0; });
+            }
+            return 1;
+        });
+        BOOST_CHECK_EQUAL(outer.get(), 1);
+
+        // an exception thrown by the task reaches the Future
+        ldl::Future<int> failed = pool.Submit([]() -> int { throw std::runtime_error("failed"); });
+        failed.wait();
+        BOOST_CHECK(failed.has_error());
+        try {
+            failed.get();
+            BOOST_CHECK(false);
+        }
+        catch (const std::runtime_error& ex) {
+            BOOST_CHECK_EQUAL(std::string(ex.what()), "failed");
+        }
+
+        // continuations can run on the pool
+        ldl::Future<int> chained = pool.Submit([]() { return 20; }).then(pool, [](int x) { return x * 2 + 2; });
+        BOOST_CHECK_EQUAL(chained.get(), 42);
+
+        // tasks without a result
+        c11::atomic<bool> ran(false);
+        ldl::Future<void> done = pool.Submit([&ran]() { ran.store(true); });
+        done.get();
+        BOOST_CHECK(ran.load());
+
+        // workers park when idle, and wake for new work
+        c11::this_thread::sleep_for(c11::chrono::milliseconds(50));
+        BOOST_CHECK_EQUAL(pool.Submit([]() { return 7; }).get(), 7);
+
+        // queued tasks run before the pool is destroyed
+        c11::atomic<int> drained(0);
+        {
+            ldl::ThreadPool small_pool(2);
+            for (int ix = 0; ix < 100; ++ix) {
+                small_pool.Submit([&drained]() { drained.fetch_add(1); return 0; });
+            }
+        }
+        BOOST_CHECK_EQUAL(drained.load(), 100);
+        for (int ix = 0; ix < 1000 && nested.load() != 200; ++ix) {
+            c11::this_thread::sleep_for(c11::chrono::milliseconds(1));
+        }
+        BOOST_CHECK_EQUAL(nested.load(), 200);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in thread_pool_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
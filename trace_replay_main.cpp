@@ -0,0 +1,76 @@
+// trace_replay: replay an allocation trace recorded by ldl::AllocationTrace against several PoolList configurations,
+// and suggest size classes and preallocation counts.
+//
+// usage: trace_replay <trace file> [growth_step] [max_size_classes]
+// growth_step must not be 0, since the baseline configuration grows its pools on demand. (default: 1)
+
+#include "allocation_replay.h"
+
+#include <cstdlib> // atoi
+#include <iostream>
+
+namespace {
+
+    //--------------
+    void WriteConfig(std::ostream& os, const ldl::ReplayConfig& config)
+    {
+        os << "  growth_step=" << config.growth_step << "\n";
+        if (!config.size_classes.empty()) {
+            os << "  size_classes=";
+            for (std::vector<size_t>::const_iterator it = config.size_classes.begin(); it != config.size_classes.end(); ++it) {
+                os << (it == config.size_classes.begin() ? "" : ",") << *it;
+            }
+            os << "\n";
+        }
+        for (std::map<size_t, size_t>::const_iterator it = config.preallocation.begin(); it != config.preallocation.end(); ++it) {
+            os << "  preallocate " << it->first << ": " << it->second << " blocks\n";
+        }
+    }
+
+    //--------------
+    void Replay(const char* name, const std::vector<ldl::AllocationTraceRecord>& records, const ldl::ReplayConfig& config)
+    {
+        std::cout << name << ":\n";
+        WriteConfig(std::cout, config);
+        std::cout << "  ";
+        ldl::AllocationReplay::WriteResult(std::cout, ldl::AllocationReplay::Run(records, config));
+    }
+
+} // namespace
+
+//--------------
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <trace file> [growth_step] [max_size_classes]\n";
+        return 2;
+    }
+    std::vector<ldl::AllocationTraceRecord> records;
+    if (!ldl::AllocationTrace::Read(argv[1], records)) {
+        std::cerr << "can't read trace file " << argv[1] << "\n";
+        return 1;
+    }
+    ldl::ReplayConfig config;
+    if (argc > 2) {
+        config.growth_step = std::atoi(argv[2]);
+    }
+    if (config.growth_step == 0) {
+        std::cerr << "growth_step must not be 0: the baseline pools must grow on demand\n";
+        return 2;
+    }
+    size_t max_classes = (argc > 3) ? static_cast<size_t>(std::atoi(argv[3])) : 8;
+    std::cout << records.size() << " records\n";
+
+    // one pool per block size, grown on demand
+    Replay("baseline", records, config);
+
+    // one pool per block size, preallocated to the peak
+    config.preallocation = ldl::AllocationReplay::SuggestPreallocation(records, config.size_classes);
+    Replay("preallocated", records, config);
+
+    // suggested size classes, preallocated to the peak
+    config.size_classes = ldl::AllocationReplay::SuggestSizeClasses(records, max_classes);
+    config.preallocation = ldl::AllocationReplay::SuggestPreallocation(records, config.size_classes);
+    Replay("size classes", records, config);
+    return 0;
+}
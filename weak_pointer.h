@@ -0,0 +1,100 @@
+#pragma once
+#ifndef LDL_WEAK_POINTER_H_
+#define LDL_WEAK_POINTER_H_
+
+#include "pooled_new.h"
+#include "shared_control.h"
+#include "shared_pointer.h"
+
+namespace ldl {
+
+    /// Almost-duplicate of c11::weak_ptr for SharedPointer.
+    /// Refers to an object managed by SharedPointer without keeping it alive. Shares the pooled ownership
+    /// state of the SharedPointer objects, so expired() is one atomic load and lock() is one compare-and-swap.
+    /// Policy must match the counting policy of the SharedPointer objects. (see LocalWeakPointer)
+    template<typename T, typename Policy = AtomicCountPolicy>
+    class WeakPointer {
+    public:
+
+        /// Type of the managed pointer.
+        typedef T element_type;
+
+        //---
+
+        // Default constructor
+        WeakPointer();
+
+        // construct from a SharedPointer
+        template<typename U>
+        WeakPointer(const SharedPointer<U, Policy>& other);
+
+        // copy constructor
+        WeakPointer(const WeakPointer& other);
+
+        // copy constructor from a different WeakPointer specialization
+        template<typename U>
+        WeakPointer(const WeakPointer<U, Policy>& other);
+
+        // destructor
+        ~WeakPointer();
+
+        // Copy assignment operator
+        WeakPointer& operator=(const WeakPointer& other);
+
+        // Copy assignment operator from a different WeakPointer specialization
+        template<typename U>
+        WeakPointer& operator=(const WeakPointer<U, Policy>& other);
+
+        // assignment from a SharedPointer
+        template<typename U>
+        WeakPointer& operator=(const SharedPointer<U, Policy>& other);
+
+        // swap state of two objects.
+        void swap(WeakPointer& other);
+
+        // Reset object to an empty state.
+        void reset();
+
+        // return the number of SharedPointer objects that own the object. (0 if expired or empty)
+        long int use_count() const;
+
+        // return true if the object has been deleted (or this object is empty).
+        bool expired() const;
+
+        // return a SharedPointer that owns the object, or an empty SharedPointer if it has expired.
+        SharedPointer<T, Policy> lock() const;
+
+    private:
+
+        template<typename U, typename P>
+        friend class WeakPointer;
+
+        /// Type of the ownership state.
+        typedef BasicSharedControl<Policy> Control;
+
+        // set state to ptr and control_ptr, and add a weak owner to control_ptr.
+        void Assign(T* ptr, Control* control_ptr);
+
+        //----
+
+        // pointer to the object (only valid while it has strong owners)
+        T* obj_ptr_;
+
+        // pointer to ownership state shared with the SharedPointer owners (0 if empty)
+        Control* control_ptr_;
+
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+
+    }; //WeakPointer<T>
+
+    /// WeakPointer for a LocalSharedPointer.
+    template<typename T>
+    using LocalWeakPointer = WeakPointer<T, LocalCountPolicy>;
+
+} //namespace ldl
+
+#include "weak_pointer.hpp"
+
+#endif //! LDL_WEAK_POINTER_H_
@@ -0,0 +1,139 @@
+#include "weak_pointer.h"
+
+#include <algorithm> // swap
+
+namespace ldl {
+
+    //-----------------
+    template<typename T, typename Policy>
+    WeakPointer<T, Policy>::WeakPointer()
+        : obj_ptr_(0)
+        , control_ptr_(0)
+    {
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    template<typename U>
+    WeakPointer<T, Policy>::WeakPointer(const SharedPointer<U, Policy>& other)
+        : obj_ptr_(0)
+        , control_ptr_(0)
+    {
+        Assign(other.obj_ptr_, other.control_ptr_);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    WeakPointer<T, Policy>::WeakPointer(const WeakPointer& other)
+        : obj_ptr_(0)
+        , control_ptr_(0)
+    {
+        Assign(other.obj_ptr_, other.control_ptr_);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    template<typename U>
+    WeakPointer<T, Policy>::WeakPointer(const WeakPointer<U, Policy>& other)
+        : obj_ptr_(0)
+        , control_ptr_(0)
+    {
+        // don't convert other.obj_ptr_ unless it is alive (conversion to a virtual base reads the object)
+        SharedPointer<U, Policy> locked = other.lock();
+        Assign(locked.get(), locked ? other.control_ptr_ : 0);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    WeakPointer<T, Policy>::~WeakPointer()
+    {
+        reset();
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    WeakPointer<T, Policy>& WeakPointer<T, Policy>::operator=(const WeakPointer& other)
+    {
+        WeakPointer(other).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    template<typename U>
+    WeakPointer<T, Policy>& WeakPointer<T, Policy>::operator=(const WeakPointer<U, Policy>& other)
+    {
+        WeakPointer(other).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    template<typename U>
+    WeakPointer<T, Policy>& WeakPointer<T, Policy>::operator=(const SharedPointer<U, Policy>& other)
+    {
+        WeakPointer(other).swap(*this);
+        return *this;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void WeakPointer<T, Policy>::swap(WeakPointer& other)
+    {
+        std::swap(obj_ptr_, other.obj_ptr_);
+        std::swap(control_ptr_, other.control_ptr_);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void WeakPointer<T, Policy>::reset()
+    {
+        Control* control_ptr = control_ptr_;
+        obj_ptr_ = 0;
+        control_ptr_ = 0;
+        if (control_ptr) {
+            control_ptr->ReleaseWeak();
+        }
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    long int WeakPointer<T, Policy>::use_count() const
+    {
+        return control_ptr_ ? control_ptr_->GetUseCount() : 0;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    bool WeakPointer<T, Policy>::expired() const
+    {
+        return (use_count() == 0);
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    SharedPointer<T, Policy> WeakPointer<T, Policy>::lock() const
+    {
+        SharedPointer<T, Policy> retval;
+        if (control_ptr_ && control_ptr_->AddRefIfNotZero()) {
+            retval.Attach(obj_ptr_, control_ptr_);
+        }
+        return retval;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    void WeakPointer<T, Policy>::Assign(T* ptr, Control* control_ptr)
+    {
+        if (control_ptr) {
+            control_ptr->AddWeakRef();
+        }
+        obj_ptr_ = ptr;
+        control_ptr_ = control_ptr;
+    }
+
+    //-----------------
+    template<typename T, typename Policy>
+    const size_t WeakPointer<T, Policy>::element_size_ = sizeof(WeakPointer<T, Policy>);
+
+} //namespace ldl
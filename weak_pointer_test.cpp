@@ -0,0 +1,110 @@
+#include "boost/test/unit_test.hpp"
+
+#include "weak_pointer.h"
+
+#include "shared_pointer.h"
+#include "static_pool_list.h"
+
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(WEAK_POINTER)
+BOOST_AUTO_TEST_CASE(weak_pointer_test)
+{
+    BOOST_TEST_MESSAGE("Starting weak_pointer_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // default constructor
+        ldl::WeakPointer<int> w1;
+        BOOST_CHECK_EQUAL(w1.expired(), true);
+        BOOST_CHECK_EQUAL(w1.use_count(), 0);
+        BOOST_CHECK_EQUAL((bool)w1.lock(), false);
+
+        // construct from SharedPointer
+        ldl::SharedPointer<int> s1(new int(4));
+        ldl::WeakPointer<int> w2(s1);
+        BOOST_CHECK_EQUAL(w2.expired(), false);
+        BOOST_CHECK_EQUAL(w2.use_count(), 1);
+        BOOST_CHECK_EQUAL(s1.use_count(), 1); // weak owners don't count
+
+        // lock
+        {
+            ldl::SharedPointer<int> s2 = w2.lock();
+            BOOST_CHECK_EQUAL(s2.get(), s1.get());
+            BOOST_CHECK_EQUAL(s1.use_count(), 2);
+        }
+        BOOST_CHECK_EQUAL(s1.use_count(), 1);
+
+        // copy and assignment
+        w1 = w2;
+        ldl::WeakPointer<int> w3(w1);
+        BOOST_CHECK_EQUAL(w3.lock().get(), s1.get());
+        w1 = s1;
+        BOOST_CHECK_EQUAL(w1.expired(), false);
+
+        // expire
+        s1.reset();
+        BOOST_CHECK_EQUAL(w1.expired(), true);
+        BOOST_CHECK_EQUAL(w2.expired(), true);
+        BOOST_CHECK_EQUAL(w3.use_count(), 0);
+        BOOST_CHECK_EQUAL((bool)w3.lock(), false);
+
+        // expired weak pointers can still be copied and reset
+        ldl::WeakPointer<int> w4(w3);
+        BOOST_CHECK_EQUAL(w4.expired(), true);
+        w4.reset();
+        w3.reset();
+
+        // works with MakeShared
+        ldl::SharedPointer<int> s3 = ldl::MakeShared<int>(9);
+        ldl::WeakPointer<int> w5(s3);
+        BOOST_CHECK_EQUAL(*w5.lock(), 9);
+        s3.reset();
+        BOOST_CHECK_EQUAL(w5.expired(), true);
+
+        // lock() races with the last strong owner being reset
+        for (size_t ix = 0; ix < 100; ++ix) {
+            ldl::SharedPointer<int> s4 = ldl::MakeShared<int>(static_cast<int>(ix));
+            ldl::WeakPointer<int> w6(s4);
+            std::thread thread([&w6, ix]() {
+                ldl::SharedPointer<int> locked = w6.lock();
+                if (locked) {
+                    BOOST_CHECK_EQUAL(*locked, static_cast<int>(ix));
+                }
+            });
+            s4.reset();
+            thread.join();
+            BOOST_CHECK_EQUAL(w6.expired(), true);
+        }
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in weak_pointer_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_CASE(local_weak_pointer_test)
+{
+    BOOST_TEST_MESSAGE("Starting local_weak_pointer_test");
+
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        ldl::LocalSharedPointer<int> s1 = ldl::MakeLocalShared<int>(7);
+        ldl::LocalWeakPointer<int> w1(s1);
+        BOOST_CHECK_EQUAL(w1.use_count(), 1);
+        BOOST_CHECK_EQUAL(w1.expired(), false);
+        ldl::LocalSharedPointer<int> s2 = w1.lock();
+        BOOST_CHECK_EQUAL(*s2, 7);
+        BOOST_CHECK_EQUAL(s1.use_count(), 2);
+
+        s1.reset();
+        s2.reset();
+        BOOST_CHECK_EQUAL(w1.expired(), true);
+        BOOST_CHECK_EQUAL((bool)w1.lock(), false);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in local_weak_pointer_test: " << ex.what());
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,209 @@
+#pragma once
+#ifndef LDL_WHEN_ALL_H_
+#define LDL_WHEN_ALL_H_
+
+#include "pooled_new.h"
+#include "future.h"
+#include "ref_counted.h"
+#include "intrusive_pointer.h"
+
+#include <atomic>
+#include <exception> // exception_ptr
+#include <iterator> // iterator_traits, distance
+#include <tuple>
+#include <utility> // index_sequence
+#include <vector>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Value of the Future returned by WhenAny(): the position of the first Future that received a value, and the value.
+    template<typename T>
+    struct WhenAnyResult {
+        WhenAnyResult(size_t index, typename FutureValue<T>::type&& value);
+        size_t index;
+        typename FutureValue<T>::type value;
+    };
+
+    //-------------
+    /// Type of the values of a range of Future objects.
+    template<typename Iterator>
+    using FutureRangeValue = typename c11::iterator_traits<Iterator>::value_type::value_type;
+
+    //-------------
+    /// Value of the Future returned by WhenAll() for a range of Future<T>: the values in order.
+    /// A range of Future<void> has no values to gather, so it gives a Future<void>.
+    template<typename T>
+    struct WhenAllRangeValue {
+        typedef std::vector<T> type;
+    };
+
+    //-------------
+    template<>
+    struct WhenAllRangeValue<void> {
+        typedef void type;
+    };
+
+    //-------------
+    /// State shared by the continuations attached by WhenAll(). Each continuation decrements remaining; the last
+    /// one moves the values out of sources into the value of result, so its waiter is woken once.
+    /// Sources is a std::vector or c11::tuple of SharedPointer<FutureState<T>>.
+    template<typename R, typename Sources>
+    struct WhenAllState : public RefCounted<WhenAllState<R, Sources>> {
+        explicit WhenAllState(size_t count);
+
+        // record that one of the Future objects is ready.
+        void Complete(size_t index);
+
+        // Future objects that aren't ready yet
+        c11::atomic<size_t> remaining;
+
+        // shared states of the Future objects
+        Sources sources;
+
+        // state of the Future returned by WhenAll()
+        SharedPointer<FutureState<R>> result;
+        //--
+        static const size_t element_size_;
+#include "pooled_new.inc"
+    };
+
+    //-------------
+    /// State shared by the continuations attached by WhenAny(). The first source with a value sets the value of result.
+    template<typename T>
+    struct WhenAnyState : public RefCounted<WhenAnyState<T>> {
+        explicit WhenAnyState(size_t count);
+
+        // record that sources[index] is ready. Moves its value to result if it is the first value.
+        // If no source sets a value, result gets the exception thrown while moving a value, if there was one,
+        // or else the error of the last source.
+        void Complete(size_t index);
+
+        // Future objects that aren't ready yet
+        c11::atomic<size_t> remaining;
+
+        // set by the first source whose value couldn't be moved to result
+        c11::atomic<bool> has_exception;
+
+        // exception thrown while moving that value
+        c11::exception_ptr exception;
+
+        // shared states of the Future objects
+        std::vector<SharedPointer<FutureState<T>>> sources;
+
+        // state of the Future returned by WhenAny()
+        SharedPointer<FutureState<WhenAnyResult<T>>> result;
+        //--
+        static const size_t element_size_;
+#include "pooled_new.inc"
+    };
+
+    //-------------
+    /// Continuation attached by WhenAll() and WhenAny() to each of their Future objects: calls Complete(index)
+    /// on the shared State.
+    template<typename State>
+    class FutureJoinContinuation : public FutureContinuation {
+    public:
+
+        // constructor
+        FutureJoinContinuation(const IntrusivePointer<State>& join, size_t index);
+
+        // complete index_ in join_, and delete this.
+        virtual void Run();
+
+    private:
+
+        IntrusivePointer<State> join_;
+        size_t index_;
+
+        //---
+
+        static const size_t element_size_;
+    public:
+#include "pooled_new.inc"
+    };
+
+    //-------------
+    /// Access to the shared state of Future objects, for WhenAll() and WhenAny().
+    struct FutureJoin {
+
+        // throw if future is invalid.
+        template<typename T>
+        static void CheckValid(const Future<T>& future);
+
+        // move the shared state out of future, which is left invalid.
+        template<typename T>
+        static SharedPointer<FutureState<T>> TakeState(Future<T>& future);
+
+        // return a Future with shared state state_ptr.
+        template<typename T>
+        static Future<T> MakeFuture(SharedPointer<FutureState<T>>& state_ptr);
+
+        // attach a continuation to source that completes index in join.
+        template<typename State, typename T>
+        static void Attach(const IntrusivePointer<State>& join, FutureState<T>& source, size_t index);
+
+        // if source holds an error, copy it to result and return true.
+        template<typename R, typename T>
+        static bool CopyError(FutureState<R>& result, FutureState<T>& source);
+
+        // copy the first error held by sources to result, and return true. Return false if there isn't one.
+        template<typename R, typename T>
+        static bool CopyError(FutureState<R>& result, std::vector<SharedPointer<FutureState<T>>>& sources);
+        template<typename R, typename... Ts>
+        static bool CopyError(FutureState<R>& result, c11::tuple<SharedPointer<FutureState<Ts>>...>& sources);
+
+        // move the values out of sources. (void values are skipped, or stored as FutureValue<void>::type in a tuple)
+        template<typename T>
+        static std::vector<T> TakeValues(std::vector<SharedPointer<FutureState<T>>>& sources);
+        static FutureValue<void>::type TakeValues(std::vector<SharedPointer<FutureState<void>>>& sources);
+        template<typename... Ts>
+        static c11::tuple<typename FutureValue<Ts>::type...> TakeValues(c11::tuple<SharedPointer<FutureState<Ts>>...>& sources);
+
+        // attach continuations to the elements of join->sources, which is a tuple.
+        template<typename State, size_t... Is>
+        static void AttachTuple(const IntrusivePointer<State>& join, c11::index_sequence<Is...>);
+
+    private:
+
+        template<typename R, typename... Ts, size_t... Is>
+        static bool CopyError(FutureState<R>& result, c11::tuple<SharedPointer<FutureState<Ts>>...>& sources, c11::index_sequence<Is...>);
+
+        template<typename... Ts, size_t... Is>
+        static c11::tuple<typename FutureValue<Ts>::type...> TakeValues(c11::tuple<SharedPointer<FutureState<Ts>>...>& sources, c11::index_sequence<Is...>);
+    };
+
+    //-------------
+    // return a Future for the values of the Future objects in [first, last), in order. Its value is set once,
+    // when every Future has a value, with one wake-up of the thread waiting for it (instead of one per Future).
+    // The values are moved, not copied.
+    // If any of them gets an error instead of a value, the returned Future gets the first error, once all are ready.
+    // The Future objects are left invalid. The state is allocated from Pools.
+    // For a range of Future<void> the returned Future is a Future<void>, ready once every one is.
+    template<typename Iterator>
+    Future<typename WhenAllRangeValue<FutureRangeValue<Iterator>>::type> WhenAll(Iterator first, Iterator last);
+
+    // same as WhenAll(first, last), for Future objects with different types.
+    // The element of a Future<void> in the tuple is an empty FutureValue<void>::type.
+    template<typename... Ts>
+    Future<c11::tuple<typename FutureValue<Ts>::type...>> WhenAll(Future<Ts>&&... futures);
+
+    // return a Future for the first value received by the Future objects in [first, last), and its position.
+    // The others are ignored. If every one gets an error instead of a value, the returned Future gets the last
+    // error. (future_errc::broken_promise if the range is empty) The Future objects are left invalid.
+    // The state is allocated from Pools.
+    template<typename Iterator>
+    Future<WhenAnyResult<FutureRangeValue<Iterator>>> WhenAny(Iterator first, Iterator last);
+
+    // same as WhenAny(first, last), for a list of Future objects.
+    template<typename T, typename... Ts>
+    Future<WhenAnyResult<T>> WhenAny(Future<T>&& first, Future<Ts>&&... rest);
+
+} //namespace ldl
+
+#include "when_all.hpp"
+
+#endif //! LDL_WHEN_ALL_H_
@@ -0,0 +1,316 @@
+#include "when_all.h"
+
+#include <stdexcept>
+#include <utility> // move
+
+namespace ldl {
+
+    //---------------
+    template<typename T>
+    WhenAnyResult<T>::WhenAnyResult(size_t index, typename FutureValue<T>::type&& value)
+        : index(index)
+        , value(c11::move(value))
+    {
+    }
+
+    //==========================
+
+    //---------------
+    template<typename R, typename Sources>
+    WhenAllState<R, Sources>::WhenAllState(size_t count)
+        : remaining(count)
+        , result(new FutureState<R>())
+    {
+    }
+
+    //---------------
+    template<typename R, typename Sources>
+    void WhenAllState<R, Sources>::Complete(size_t)
+    {
+        // acq_rel, so the last one sees the values set in the other sources
+        if (remaining.fetch_sub(1, c11::memory_order_acq_rel) != 1) {
+            return;
+        }
+        if (FutureJoin::CopyError(*result, sources)) {
+            return;
+        }
+        try {
+            result->Emplace(FutureJoin::TakeValues(sources));
+        }
+        catch (...) {
+            result->TrySetException(c11::current_exception());
+        }
+    }
+
+    //---------------
+    template<typename R, typename Sources>
+    const size_t WhenAllState<R, Sources>::element_size_ = sizeof(WhenAllState<R, Sources>);
+
+    //==========================
+
+    //---------------
+    template<typename T>
+    WhenAnyState<T>::WhenAnyState(size_t count)
+        : remaining(count)
+        , has_exception(false)
+        , result(new FutureState<WhenAnyResult<T>>())
+    {
+    }
+
+    //---------------
+    template<typename T>
+    void WhenAnyState<T>::Complete(size_t index)
+    {
+        // only the first value claims result. The others don't throw or move anything.
+        FutureState<T>& source = *sources[index];
+        if (!source.HasError()) {
+            try {
+                result->TryEmplace(index, c11::move(source.GetValue()));
+            }
+            catch (...) {
+                // another source may still set result. Sources that completed meanwhile found it claimed and
+                // gave up, so keep the exception for the case that none does.
+                if (!has_exception.exchange(true, c11::memory_order_relaxed)) {
+                    exception = c11::current_exception();
+                }
+            }
+        }
+        if (remaining.fetch_sub(1, c11::memory_order_acq_rel) == 1) {
+            // every source is ready. These do nothing if a value was set.
+            if (has_exception.load(c11::memory_order_relaxed)) {
+                result->TrySetException(exception);
+            }
+            else if (source.HasError()) {
+                result->TryCopyError(source);
+            }
+            else {
+                result->Abandon();
+            }
+        }
+    }
+
+    //---------------
+    template<typename T>
+    const size_t WhenAnyState<T>::element_size_ = sizeof(WhenAnyState<T>);
+
+    //==========================
+
+    //---------------
+    template<typename State>
+    FutureJoinContinuation<State>::FutureJoinContinuation(const IntrusivePointer<State>& join, size_t index)
+        : FutureContinuation(InlineExecutor::Instance())
+        , join_(join)
+        , index_(index)
+    {
+    }
+
+    //---------------
+    template<typename State>
+    void FutureJoinContinuation<State>::Run()
+    {
+        join_->Complete(index_);
+        delete this;
+    }
+
+    //---------------
+    template<typename State>
+    const size_t FutureJoinContinuation<State>::element_size_ = sizeof(FutureJoinContinuation<State>);
+
+    //==========================
+
+    //---------------
+    template<typename T>
+    void FutureJoin::CheckValid(const Future<T>& future)
+    {
+        if (!future.valid()) {
+            throw std::runtime_error("future is not valid");
+        }
+    }
+
+    //---------------
+    template<typename T>
+    SharedPointer<FutureState<T>> FutureJoin::TakeState(Future<T>& future)
+    {
+        SharedPointer<FutureState<T>> retval;
+        retval.swap(future.state_ptr_);
+        return retval;
+    }
+
+    //---------------
+    template<typename T>
+    Future<T> FutureJoin::MakeFuture(SharedPointer<FutureState<T>>& state_ptr)
+    {
+        return Future<T>(state_ptr);
+    }
+
+    //---------------
+    template<typename State, typename T>
+    void FutureJoin::Attach(const IntrusivePointer<State>& join, FutureState<T>& source, size_t index)
+    {
+        FutureJoinContinuation<State>* continuation = new FutureJoinContinuation<State>(join, index);
+        try {
+            source.SetContinuation(continuation);
+        }
+        catch (...) {
+            delete continuation;
+            throw;
+        }
+    }
+
+    //---------------
+    template<typename R, typename T>
+    bool FutureJoin::CopyError(FutureState<R>& result, FutureState<T>& source)
+    {
+        if (!source.HasError()) {
+            return false;
+        }
+        result.TryCopyError(source);
+        return true;
+    }
+
+    //---------------
+    template<typename R, typename T>
+    bool FutureJoin::CopyError(FutureState<R>& result, std::vector<SharedPointer<FutureState<T>>>& sources)
+    {
+        for (size_t ix = 0; ix < sources.size(); ++ix) {
+            if (CopyError(result, *sources[ix])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //---------------
+    template<typename R, typename... Ts>
+    bool FutureJoin::CopyError(FutureState<R>& result, c11::tuple<SharedPointer<FutureState<Ts>>...>& sources)
+    {
+        return CopyError(result, sources, c11::index_sequence_for<Ts...>());
+    }
+
+    //---------------
+    template<typename R, typename... Ts, size_t... Is>
+    bool FutureJoin::CopyError(FutureState<R>& result, c11::tuple<SharedPointer<FutureState<Ts>>...>& sources, c11::index_sequence<Is...>)
+    {
+        // braced lists are evaluated in order, so the first error is copied
+        bool copied = false;
+        bool expand[] = { false, (copied = copied || CopyError(result, *c11::get<Is>(sources)))... };
+        (void)expand;
+        return copied;
+    }
+
+    //---------------
+    template<typename T>
+    std::vector<T> FutureJoin::TakeValues(std::vector<SharedPointer<FutureState<T>>>& sources)
+    {
+        std::vector<T> retval;
+        retval.reserve(sources.size());
+        for (size_t ix = 0; ix < sources.size(); ++ix) {
+            retval.push_back(c11::move(sources[ix]->GetValue()));
+        }
+        return retval;
+    }
+
+    //---------------
+    inline FutureValue<void>::type FutureJoin::TakeValues(std::vector<SharedPointer<FutureState<void>>>&)
+    {
+        return FutureValue<void>::type();
+    }
+
+    //---------------
+    template<typename... Ts>
+    c11::tuple<typename FutureValue<Ts>::type...> FutureJoin::TakeValues(c11::tuple<SharedPointer<FutureState<Ts>>...>& sources)
+    {
+        return TakeValues(sources, c11::index_sequence_for<Ts...>());
+    }
+
+    //---------------
+    template<typename... Ts, size_t... Is>
+    c11::tuple<typename FutureValue<Ts>::type...> FutureJoin::TakeValues(c11::tuple<SharedPointer<FutureState<Ts>>...>& sources, c11::index_sequence<Is...>)
+    {
+        return c11::tuple<typename FutureValue<Ts>::type...>(c11::move(c11::get<Is>(sources)->GetValue())...);
+    }
+
+    //---------------
+    template<typename State, size_t... Is>
+    void FutureJoin::AttachTuple(const IntrusivePointer<State>& join, c11::index_sequence<Is...>)
+    {
+        int expand[] = { 0, (Attach(join, *c11::get<Is>(join->sources), Is), 0)... };
+        (void)expand;
+    }
+
+    //==========================
+
+    //---------------
+    template<typename Iterator>
+    Future<typename WhenAllRangeValue<FutureRangeValue<Iterator>>::type> WhenAll(Iterator first, Iterator last)
+    {
+        typedef FutureRangeValue<Iterator> T;
+        typedef typename WhenAllRangeValue<T>::type R;
+        typedef WhenAllState<R, std::vector<SharedPointer<FutureState<T>>>> State;
+        for (Iterator it = first; it != last; ++it) {
+            FutureJoin::CheckValid(*it);
+        }
+        // one extra count, so the value isn't set before every continuation is attached
+        size_t count = static_cast<size_t>(c11::distance(first, last));
+        IntrusivePointer<State> all(new State(count + 1));
+        all->sources.reserve(count);
+        for (Iterator it = first; it != last; ++it) {
+            all->sources.push_back(FutureJoin::TakeState(*it));
+        }
+        Future<R> retval = FutureJoin::MakeFuture(all->result);
+        for (size_t ix = 0; ix < count; ++ix) {
+            FutureJoin::Attach(all, *all->sources[ix], ix);
+        }
+        all->Complete(count);
+        return retval;
+    }
+
+    //---------------
+    template<typename... Ts>
+    Future<c11::tuple<typename FutureValue<Ts>::type...>> WhenAll(Future<Ts>&&... futures)
+    {
+        typedef c11::tuple<typename FutureValue<Ts>::type...> R;
+        typedef WhenAllState<R, c11::tuple<SharedPointer<FutureState<Ts>>...>> State;
+        int expand[] = { 0, (FutureJoin::CheckValid(futures), 0)... };
+        (void)expand;
+        IntrusivePointer<State> all(new State(sizeof...(Ts) + 1));
+        all->sources = c11::make_tuple(FutureJoin::TakeState(futures)...);
+        Future<R> retval = FutureJoin::MakeFuture(all->result);
+        FutureJoin::AttachTuple(all, c11::index_sequence_for<Ts...>());
+        all->Complete(sizeof...(Ts));
+        return retval;
+    }
+
+    //---------------
+    template<typename Iterator>
+    Future<WhenAnyResult<FutureRangeValue<Iterator>>> WhenAny(Iterator first, Iterator last)
+    {
+        typedef FutureRangeValue<Iterator> T;
+        for (Iterator it = first; it != last; ++it) {
+            FutureJoin::CheckValid(*it);
+        }
+        size_t count = static_cast<size_t>(c11::distance(first, last));
+        IntrusivePointer<WhenAnyState<T>> any(new WhenAnyState<T>(count));
+        any->sources.reserve(count);
+        for (Iterator it = first; it != last; ++it) {
+            any->sources.push_back(FutureJoin::TakeState(*it));
+        }
+        Future<WhenAnyResult<T>> retval = FutureJoin::MakeFuture(any->result);
+        if (count == 0) {
+            any->result->Abandon();
+        }
+        for (size_t ix = 0; ix < count; ++ix) {
+            FutureJoin::Attach(any, *any->sources[ix], ix);
+        }
+        return retval;
+    }
+
+    //---------------
+    template<typename T, typename... Ts>
+    Future<WhenAnyResult<T>> WhenAny(Future<T>&& first, Future<Ts>&&... rest)
+    {
+        Future<T> futures[] = { c11::move(first), c11::move(rest)... };
+        return WhenAny(futures, futures + 1 + sizeof...(Ts));
+    }
+
+} //namespace ldl
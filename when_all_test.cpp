@@ -0,0 +1,237 @@
+#include "boost/test/unit_test.hpp"
+
+#include "when_all.h"
+#include "thread_pool.h"
+
+#include "static_pool_list.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+    // value whose move constructor throws if it was told to.
+    struct ThrowingMove {
+        explicit ThrowingMove(bool throws) : throws(throws) {}
+        ThrowingMove(ThrowingMove&& other) : throws(other.throws)
+        {
+            if (throws) {
+                throw std::logic_error("move");
+            }
+        }
+        bool throws;
+    };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(WHEN_ALL)
+
+BOOST_AUTO_TEST_CASE(when_all_test)
+{
+    BOOST_TEST_MESSAGE("Starting when_all_test");
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // ready once every value is set, in order
+        std::vector<ldl::Promise<int>> promises(5);
+        std::vector<ldl::Future<int>> futures;
+        for (size_t ix = 0; ix < promises.size(); ++ix) {
+            futures.push_back(promises[ix].get_future());
+        }
+        ldl::Future<std::vector<int>> all = ldl::WhenAll(futures.begin(), futures.end());
+        BOOST_CHECK_EQUAL(futures[0].valid(), false);
+        for (size_t ix = promises.size(); ix-- > 1;) {
+            promises[ix].set_value(static_cast<int>(ix * 10));
+        }
+        BOOST_CHECK(all.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::timeout);
+        promises[0].set_value(0);
+        std::vector<int> values = all.get();
+        BOOST_CHECK_EQUAL(values.size(), 5u);
+        for (size_t ix = 0; ix < values.size(); ++ix) {
+            BOOST_CHECK_EQUAL(values[ix], static_cast<int>(ix * 10));
+        }
+
+        // empty range is ready at once
+        std::vector<ldl::Future<int>> none;
+        BOOST_CHECK_EQUAL(ldl::WhenAll(none.begin(), none.end()).get().size(), 0u);
+
+        // different types
+        ldl::Promise<int> prom1;
+        ldl::Promise<std::string> prom2;
+        ldl::Future<c11::tuple<int, std::string>> both = ldl::WhenAll(prom1.get_future(), prom2.get_future());
+        prom2.set_value("two");
+        prom1.set_value(1);
+        c11::tuple<int, std::string> tuple = both.get();
+        BOOST_CHECK_EQUAL(c11::get<0>(tuple), 1);
+        BOOST_CHECK_EQUAL(c11::get<1>(tuple), "two");
+
+        // the first error reaches the result
+        ldl::Promise<int> prom7;
+        ldl::Promise<int> prom8;
+        ldl::Future<c11::tuple<int, int>> errors = ldl::WhenAll(prom7.get_future(), prom8.get_future());
+        prom8.set_error(c11::make_error_code(c11::errc::timed_out));
+        prom7.set_exception(c11::make_exception_ptr(std::logic_error("first")));
+        BOOST_CHECK_THROW(errors.get(), std::logic_error);
+
+        // a reset Promise reaches the result
+        ldl::Promise<int> prom3;
+        ldl::Future<std::vector<int>> failed;
+        {
+            ldl::Promise<int> prom4;
+            ldl::Future<int> pair[] = { prom3.get_future(), prom4.get_future() };
+            failed = ldl::WhenAll(pair, pair + 2);
+        }
+        prom3.set_value(3);
+        BOOST_CHECK_THROW(failed.get(), std::runtime_error);
+
+        // values are moved, not copied
+        ldl::Promise<std::unique_ptr<int>> prom5;
+        ldl::Promise<std::unique_ptr<int>> prom6;
+        ldl::Future<std::unique_ptr<int>> owners[] = { prom5.get_future(), prom6.get_future() };
+        ldl::Future<std::vector<std::unique_ptr<int>>> moved = ldl::WhenAll(owners, owners + 2);
+        prom5.set_value(std::unique_ptr<int>(new int(5)));
+        prom6.set_value(std::unique_ptr<int>(new int(6)));
+        std::vector<std::unique_ptr<int>> ptrs = moved.get();
+        BOOST_CHECK_EQUAL(*ptrs[0] + *ptrs[1], 11);
+
+        // invalid Future
+        ldl::Future<int> invalid;
+        BOOST_CHECK_THROW(ldl::WhenAll(&invalid, &invalid + 1), std::runtime_error);
+
+        // values set by many threads
+        ldl::ThreadPool pool(4);
+        std::vector<ldl::Future<int>> results;
+        for (int ix = 0; ix < 200; ++ix) {
+            results.push_back(pool.Submit([ix]() { return ix; }));
+        }
+        std::vector<int> gathered = ldl::WhenAll(results.begin(), results.end()).get();
+        int sum = 0;
+        for (size_t ix = 0; ix < gathered.size(); ++ix) {
+            sum += gathered[ix];
+        }
+        BOOST_CHECK_EQUAL(sum, 199 * 200 / 2);
+
+        // tasks without a value
+        std::atomic<int> done(0);
+        std::vector<ldl::Future<void>> tasks;
+        for (int ix = 0; ix < 100; ++ix) {
+            tasks.push_back(pool.Submit([&done]() { ++done; }));
+        }
+        ldl::Future<void> all_done = ldl::WhenAll(tasks.begin(), tasks.end());
+        all_done.get();
+        BOOST_CHECK_EQUAL(done.load(), 100);
+        std::vector<ldl::Future<void>> no_tasks;
+        ldl::WhenAll(no_tasks.begin(), no_tasks.end()).get();
+
+        ldl::Promise<void> prom9;
+        ldl::Promise<void> prom10;
+        ldl::Future<void> pair9[] = { prom9.get_future(), prom10.get_future() };
+        ldl::Future<void> void_error = ldl::WhenAll(pair9, pair9 + 2);
+        prom9.set_value();
+        prom10.set_error(c11::make_error_code(c11::errc::timed_out));
+        BOOST_CHECK(void_error.get_error_code() == c11::errc::timed_out);
+
+        ldl::Promise<int> prom11;
+        ldl::Promise<void> prom12;
+        ldl::Future<c11::tuple<int, ldl::FutureValue<void>::type>> mixed = ldl::WhenAll(prom11.get_future(), prom12.get_future());
+        prom12.set_value();
+        prom11.set_value(11);
+        BOOST_CHECK_EQUAL(c11::get<0>(mixed.get()), 11);
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in when_all_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(when_any_test)
+{
+    BOOST_TEST_MESSAGE("Starting when_any_test");
+    try {
+        ldl::StaticPoolList::SetPoolGrowthStep(0, 10);
+
+        // first value wins
+        std::vector<ldl::Promise<int>> promises(4);
+        std::vector<ldl::Future<int>> futures;
+        for (size_t ix = 0; ix < promises.size(); ++ix) {
+            futures.push_back(promises[ix].get_future());
+        }
+        ldl::Future<ldl::WhenAnyResult<int>> any = ldl::WhenAny(futures.begin(), futures.end());
+        BOOST_CHECK(any.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::timeout);
+        promises[2].set_value(20);
+        promises[1].set_value(10);
+        ldl::WhenAnyResult<int> first = any.get();
+        BOOST_CHECK_EQUAL(first.index, 2u);
+        BOOST_CHECK_EQUAL(first.value, 20);
+
+        // a reset Promise is skipped while others may still set a value
+        ldl::Promise<int> prom1;
+        ldl::Future<ldl::WhenAnyResult<int>> any2;
+        {
+            ldl::Promise<int> prom2;
+            any2 = ldl::WhenAny(prom2.get_future(), prom1.get_future());
+        }
+        BOOST_CHECK(any2.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::timeout);
+        prom1.set_value(1);
+        BOOST_CHECK_EQUAL(any2.get().index, 1u);
+
+        // every Promise reset, or empty range
+        ldl::Future<ldl::WhenAnyResult<int>> any3;
+        {
+            ldl::Promise<int> prom3;
+            any3 = ldl::WhenAny(prom3.get_future());
+        }
+        BOOST_CHECK(any3.get_error_code() == c11::future_errc::broken_promise);
+        ldl::Promise<int> prom4;
+        ldl::Promise<int> prom5;
+        ldl::Future<ldl::WhenAnyResult<int>> any4 = ldl::WhenAny(prom4.get_future(), prom5.get_future());
+        prom4.set_error(c11::make_error_code(c11::errc::timed_out));
+        BOOST_CHECK(any4.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::timeout);
+        prom5.set_error(c11::make_error_code(c11::errc::operation_canceled));
+        BOOST_CHECK(any4.get_error_code() == c11::errc::operation_canceled);
+        std::vector<ldl::Future<int>> none;
+        BOOST_CHECK_THROW(ldl::WhenAny(none.begin(), none.end()).get(), std::runtime_error);
+
+        // values set by many threads at once
+        ldl::ThreadPool pool(4);
+        for (int round = 0; round < 20; ++round) {
+            std::vector<ldl::Future<int>> results;
+            for (int ix = 0; ix < 8; ++ix) {
+                results.push_back(pool.Submit([ix]() { return ix; }));
+            }
+            ldl::WhenAnyResult<int> winner = ldl::WhenAny(results.begin(), results.end()).get();
+            BOOST_CHECK_EQUAL(winner.value, static_cast<int>(winner.index));
+        }
+
+        // a value that can't be moved to the result
+        ldl::Promise<ThrowingMove> prom7;
+        ldl::Promise<ThrowingMove> prom8;
+        ldl::Promise<ThrowingMove> prom9;
+        ldl::Future<ldl::WhenAnyResult<ThrowingMove>> any6 = ldl::WhenAny(prom7.get_future(), prom8.get_future());
+        ldl::Future<ldl::WhenAnyResult<ThrowingMove>> any7 = ldl::WhenAny(prom9.get_future());
+        prom7.emplace_value(true);
+        BOOST_CHECK(any6.wait_for(c11::chrono::milliseconds(0)) == ldl::FutureStatus::timeout);
+        prom8.emplace_value(false);
+        BOOST_CHECK_EQUAL(any6.get().index, 1u); // a later value still wins
+        prom9.emplace_value(true);
+        BOOST_CHECK_EQUAL(any7.has_error(), true);
+        BOOST_CHECK(!any7.get_error_code()); // not broken_promise
+        BOOST_CHECK_THROW(any7.get(), std::logic_error);
+
+        // tasks without a value
+        std::vector<ldl::Future<void>> tasks;
+        ldl::Promise<void> never;
+        tasks.push_back(never.get_future());
+        tasks.push_back(pool.Submit([]() {}));
+        BOOST_CHECK_EQUAL(ldl::WhenAny(tasks.begin(), tasks.end()).get().index, 1u);
+        never.set_value();
+    }
+    catch (const std::exception& ex) {
+        BOOST_TEST_MESSAGE("exception in when_any_test: " << ex.what());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
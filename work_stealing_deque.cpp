@@ -0,0 +1,124 @@
+#include "work_stealing_deque.h"
+
+namespace ldl {
+
+    //--------------
+    WorkStealingDeque::Array::Array(size_t capacity)
+        : capacity(capacity)
+        , mask(capacity - 1)
+        , slots(new c11::atomic<ExecutorTask*>[capacity])
+    {
+    }
+
+    //--------------
+    ExecutorTask* WorkStealingDeque::Array::Get(c11::int64_t index) const
+    {
+        return slots[static_cast<size_t>(index) & mask].load(c11::memory_order_relaxed);
+    }
+
+    //--------------
+    void WorkStealingDeque::Array::Put(c11::int64_t index, ExecutorTask* task)
+    {
+        slots[static_cast<size_t>(index) & mask].store(task, c11::memory_order_relaxed);
+    }
+
+    //==========================
+
+    //--------------
+    WorkStealingDeque::WorkStealingDeque(size_t capacity)
+        : top_(0)
+        , bottom_(0)
+        , array_(0)
+    {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        Array* array = new Array(rounded);
+        arrays_.push_back(array);
+        array_.store(array, c11::memory_order_relaxed);
+    }
+
+    //--------------
+    WorkStealingDeque::~WorkStealingDeque()
+    {
+        for (size_t ix = 0; ix < arrays_.size(); ++ix) {
+            delete[] arrays_[ix]->slots;
+            delete arrays_[ix];
+        }
+    }
+
+    //--------------
+    void WorkStealingDeque::Push(ExecutorTask* task)
+    {
+        c11::int64_t bottom = bottom_.load(c11::memory_order_relaxed);
+        c11::int64_t top = top_.load(c11::memory_order_acquire);
+        Array* array = array_.load(c11::memory_order_relaxed);
+        if (bottom - top > static_cast<c11::int64_t>(array->capacity) - 1) {
+            array = Grow(array, top, bottom);
+        }
+        array->Put(bottom, task);
+        // release, so a thief that sees the new bottom also sees the task and its contents.
+        bottom_.store(bottom + 1, c11::memory_order_release);
+    }
+
+    //--------------
+    ExecutorTask* WorkStealingDeque::Take()
+    {
+        c11::int64_t bottom = bottom_.load(c11::memory_order_relaxed) - 1;
+        Array* array = array_.load(c11::memory_order_relaxed);
+        // claim the bottom task before looking at top. (seq_cst orders the store before the load of top)
+        bottom_.store(bottom, c11::memory_order_seq_cst);
+        c11::int64_t top = top_.load(c11::memory_order_seq_cst);
+        ExecutorTask* retval = 0;
+        if (top <= bottom) {
+            retval = array->Get(bottom);
+            if (top == bottom) {
+                // last task: race thieves for it
+                if (!top_.compare_exchange_strong(top, top + 1, c11::memory_order_seq_cst, c11::memory_order_relaxed)) {
+                    retval = 0;
+                }
+                bottom_.store(bottom + 1, c11::memory_order_relaxed);
+            }
+        }
+        else { // empty
+            bottom_.store(bottom + 1, c11::memory_order_relaxed);
+        }
+        return retval;
+    }
+
+    //--------------
+    ExecutorTask* WorkStealingDeque::Steal()
+    {
+        c11::int64_t top = top_.load(c11::memory_order_seq_cst);
+        c11::int64_t bottom = bottom_.load(c11::memory_order_seq_cst);
+        if (top >= bottom) {
+            return 0;
+        }
+        Array* array = array_.load(c11::memory_order_acquire);
+        ExecutorTask* retval = array->Get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, c11::memory_order_seq_cst, c11::memory_order_relaxed)) {
+            return 0; // lost the race
+        }
+        return retval;
+    }
+
+    //--------------
+    bool WorkStealingDeque::IsEmpty() const
+    {
+        return (top_.load(c11::memory_order_relaxed) >= bottom_.load(c11::memory_order_relaxed));
+    }
+
+    //--------------
+    WorkStealingDeque::Array* WorkStealingDeque::Grow(Array* array, c11::int64_t top, c11::int64_t bottom)
+    {
+        Array* retval = new Array(array->capacity * 2);
+        for (c11::int64_t ix = top; ix < bottom; ++ix) {
+            retval->Put(ix, array->Get(ix));
+        }
+        arrays_.push_back(retval);
+        array_.store(retval, c11::memory_order_release);
+        return retval;
+    }
+
+} //namespace ldl
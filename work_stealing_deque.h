@@ -0,0 +1,80 @@
+#pragma once
+#ifndef LDL_WORK_STEALING_DEQUE_H_
+#define LDL_WORK_STEALING_DEQUE_H_
+
+#include "executor.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+namespace c11 {
+    using namespace std;
+}
+
+namespace ldl {
+
+    //-------------
+    /// Chase-Lev work-stealing deque of tasks. (with the memory orders of Le et al., "Correct and Efficient
+    /// Work-Stealing for Weak Memory Models", 2013)
+    /// The owner thread pushes and takes tasks at the bottom without locks or (usually) read-modify-write
+    /// operations, and any other thread can steal from the top with one compare-and-swap.
+    /// The array grows when it is full. Old arrays are kept until the deque is destroyed, because a thief
+    /// may still be reading one.
+    class WorkStealingDeque {
+    public:
+
+        // constructor. capacity is rounded up to a power of 2.
+        explicit WorkStealingDeque(size_t capacity = 256);
+
+        // destructor. (tasks still in the deque are not deleted)
+        ~WorkStealingDeque();
+
+        // add task at the bottom. Only called by the owner.
+        void Push(ExecutorTask* task);
+
+        // remove the task at the bottom, or return 0 if the deque is empty. Only called by the owner.
+        ExecutorTask* Take();
+
+        // remove the task at the top, or return 0 if the deque is empty or another thread took the task first.
+        ExecutorTask* Steal();
+
+        // return true if the deque looks empty. (may be stale if other threads are using it)
+        bool IsEmpty() const;
+
+    private:
+
+        //-------------
+        // circular array of tasks
+        struct Array {
+            explicit Array(size_t capacity);
+            ExecutorTask* Get(c11::int64_t index) const;
+            void Put(c11::int64_t index, ExecutorTask* task);
+            size_t capacity;
+            size_t mask;
+            c11::atomic<ExecutorTask*>* slots;
+        };
+
+        // replace the array with one twice as large, holding the tasks in [top, bottom). Returns the new array.
+        Array* Grow(Array* array, c11::int64_t top, c11::int64_t bottom);
+
+        //---
+
+        // index of the next task to steal
+        c11::atomic<c11::int64_t> top_;
+
+        // index after the last task pushed
+        c11::atomic<c11::int64_t> bottom_;
+
+        // current array
+        c11::atomic<Array*> array_;
+
+        // every array allocated, including the current one. (only used by the owner)
+        std::vector<Array*> arrays_;
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    };
+
+} //namespace ldl
+
+#endif //! LDL_WORK_STEALING_DEQUE_H_